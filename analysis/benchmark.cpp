@@ -16,6 +16,7 @@ void runBenchmark(StorageEngine& storage, int N) {
     string tHeap = "BenchHeap_" + suffix;
     string tAvl = "BenchAVL_" + suffix;
     string tHash = "BenchHash_" + suffix;
+    string tBtree = "BenchBTree_" + suffix;
 
     vector<Column> cols = {{"id", "INT"}, {"val", "STRING"}};
 
@@ -28,6 +29,7 @@ void runBenchmark(StorageEngine& storage, int N) {
     storage.createTable(tHeap, cols, "HEAP");
     storage.createTable(tAvl, cols, "AVL");
     storage.createTable(tHash, cols, "HASH");
+    storage.createTable(tBtree, cols, "BTREE");
 
     // 2. INSERTION TEST
 
@@ -60,6 +62,15 @@ void runBenchmark(StorageEngine& storage, int N) {
     end = chrono::high_resolution_clock::now();
     cout << "  HASH: " << chrono::duration_cast<chrono::milliseconds>(end - start).count() << "ms" << endl;
 
+    // BTREE
+    start = chrono::high_resolution_clock::now();
+    for (int i = 0; i < N; i++) {
+        Record r; r.fields = {i, "data" + to_string(i)};
+        storage.insertRecord(tBtree, r);
+    }
+    end = chrono::high_resolution_clock::now();
+    cout << "  BTREE: " << chrono::duration_cast<chrono::milliseconds>(end - start).count() << "ms" << endl;
+
     // -------------------------------------------------
     // 3. POINT SEARCH TEST (Find ID = N-1)
     // -------------------------------------------------
@@ -84,6 +95,12 @@ void runBenchmark(StorageEngine& storage, int N) {
     end = chrono::high_resolution_clock::now();
     cout << "  HASH (Direct)  : " << chrono::duration_cast<chrono::microseconds>(end - start).count() << "us" << endl;
 
+    // BTREE (Paged, on disk)
+    start = chrono::high_resolution_clock::now();
+    storage.search(tBtree, target);
+    end = chrono::high_resolution_clock::now();
+    cout << "  BTREE (Paged)  : " << chrono::duration_cast<chrono::microseconds>(end - start).count() << "us" << endl;
+
     // -------------------------------------------------
     // 4. RANGE SEARCH TEST (ID > N/2)
     // -------------------------------------------------
@@ -128,6 +145,72 @@ void runBenchmark(StorageEngine& storage, int N) {
     auto timeSort = chrono::duration_cast<chrono::microseconds>(end - start).count();
     cout << "  Sort + Search  : " << timeSort << "us (Count: " << countSort << ")" << endl;
 
+    // C. BTREE leaf chain (reads the matching leaves only)
+    start = chrono::high_resolution_clock::now();
+    size_t countTree = storage.selectRange(tBtree, N / 2 + 1, N).size();
+    end = chrono::high_resolution_clock::now();
+    cout << "  BTREE Leaves   : " << chrono::duration_cast<chrono::microseconds>(end - start).count() << "us (Count: " << countTree << ")" << endl;
+
+    // -------------------------------------------------
+    // 5. FULL SCAN TEST (buffer pool vs mmap)
+    // -------------------------------------------------
+    cout << "\n[FULL SCAN] SELECT * on HEAP..." << endl;
+
+    storage.setScanMode(StorageEngine::ScanMode::BUFFERED);
+    start = chrono::high_resolution_clock::now();
+    size_t scanned = storage.selectAll(tHeap).size();
+    end = chrono::high_resolution_clock::now();
+    cout << "  Buffered       : " << chrono::duration_cast<chrono::microseconds>(end - start).count() << "us (Rows: " << scanned << ")" << endl;
+
+    storage.setScanMode(StorageEngine::ScanMode::MMAP);
+    start = chrono::high_resolution_clock::now();
+    scanned = storage.selectAll(tHeap).size();
+    end = chrono::high_resolution_clock::now();
+    cout << "  mmap           : " << chrono::duration_cast<chrono::microseconds>(end - start).count() << "us (Rows: " << scanned << ")" << endl;
+    storage.setScanMode(StorageEngine::ScanMode::BUFFERED);
+
+    // -------------------------------------------------
+    // 6. PAGE SIZE TEST (the same rows in HEAP tables of each page size)
+    // -------------------------------------------------
+    // A 1 MB buffer pool keeps most pages out of memory, so lookups and scans
+    // pay for the pages they read: large pages favour the scan, small ones lookups
+    cout << "\n[PAGE SIZE] HEAP load, full scan and 1000 lookups by id (1 MB buffer pool)..." << endl;
+    storage.setBufferPoolSize(1024 * 1024);
+    for (uint32_t pageSize : {4096u, 8192u, 16384u, 32768u, 65536u}) {
+        string tPage = "BenchPage" + to_string(pageSize / 1024) + "K_" + suffix;
+        storage.createTable(tPage, cols, "HEAP", false, pageSize);
+
+        start = chrono::high_resolution_clock::now();
+        vector<Record> batch;
+        for (int i = 0; i < N; i++) {
+            Record r; r.fields = {i, "data" + to_string(i)};
+            batch.push_back(r);
+            if (batch.size() == 1000 || i == N - 1) {
+                storage.insertRecords(tPage, batch);
+                batch.clear();
+            }
+        }
+        end = chrono::high_resolution_clock::now();
+        long long loadMs = chrono::duration_cast<chrono::milliseconds>(end - start).count();
+
+        start = chrono::high_resolution_clock::now();
+        scanned = storage.selectAll(tPage).size();
+        end = chrono::high_resolution_clock::now();
+        long long scanUs = chrono::duration_cast<chrono::microseconds>(end - start).count();
+
+        start = chrono::high_resolution_clock::now();
+        int found = 0;
+        for (int i = 0; i < 1000; i++) {
+            if (storage.findRecord(tPage, static_cast<int>((i * 7919LL) % N))) found++;
+        }
+        end = chrono::high_resolution_clock::now();
+        long long lookupUs = chrono::duration_cast<chrono::microseconds>(end - start).count();
+
+        cout << "  " << (pageSize / 1024) << " KB pages: load " << loadMs << "ms, scan " << scanUs << "us (Rows: " << scanned
+             << "), lookups " << lookupUs << "us (Found: " << found << "), " << storage.heapStats(tPage).pages << " pages" << endl;
+    }
+    storage.setBufferPoolSize(DEFAULT_BUFFER_POOL_BYTES);
+
 }
 
 int main() {
@@ -146,6 +229,8 @@ int main() {
 
     // distinct folder
     StorageEngine storage("analysis_data");
+    // Measure the structures, not fsync latency: commits return before the log hits disk
+    storage.setDurabilityMode(DurabilityMode::ASYNC);
     
     // N = 1,000
     runBenchmark(storage, 1000);
@@ -1,7 +1,7 @@
 @echo off
 echo Compiling ChronoDB GUI...
 
-g++ -std=c++17 -o chronodb_gui.exe -I. -I "raylib-5.5_win64_mingw-w64/include" -L "raylib-5.5_win64_mingw-w64/lib" src/gui.cpp query/lexer.cpp query/parser.cpp storage/storage.cpp graph/graph.cpp utils/helpers.cpp utils/sorting.cpp -lraylib -lgdi32 -lwinmm
+g++ -std=c++17 -o chronodb_gui.exe -I. -I "raylib-5.5_win64_mingw-w64/include" -L "raylib-5.5_win64_mingw-w64/lib" src/gui.cpp query/lexer.cpp query/parser.cpp storage/storage.cpp storage/page.cpp storage/buffer_pool.cpp storage/paged_file.cpp storage/free_space_map.cpp storage/vacuum.cpp storage/bplus_tree.cpp storage/primary_index.cpp storage/btree_table.cpp storage/structure_snapshot.cpp storage/catalog.cpp storage/table_cursor.cpp storage/record_view.cpp storage/record_codec.cpp storage/column_segment.cpp storage/columnar_table.cpp storage/bulk_load.cpp storage/read_ahead.cpp storage/wal.cpp graph/graph.cpp utils/helpers.cpp utils/sorting.cpp -lraylib -lgdi32 -lwinmm
 
 if %ERRORLEVEL% EQU 0 (
     echo.
@@ -19,10 +19,12 @@ namespace ChronoDB {
         while (isspace(current())) advance();
     }
 
+    // "text" or 'text'
     Token Lexer::readString() {
+        char quote = current();
         advance(); 
         string val;
-        while (current() != '"' && current() != '\0') {
+        while (current() != quote && current() != '\0') {
             val += current();
             advance();
         }
@@ -54,7 +56,7 @@ namespace ChronoDB {
 
         if (isalpha(current())) return readIdentifierOrKeyword();
         if (isdigit(current())) return readNumber();
-        if (current() == '"') return readString();
+        if (current() == '"' || current() == '\'') return readString();
 
         char c = current();
         advance();
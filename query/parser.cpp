@@ -2,6 +2,10 @@
 #include <iostream>
 #include <cmath>
 #include <cctype>
+#include <cstdio>
+#include <climits>
+#include <algorithm>
+#include <iterator>
 #include "../utils/types.h"
 #include "../utils/helpers.h"
 #include "../utils/sorting.h"
@@ -57,7 +61,7 @@ namespace ChronoDB {
 
         if (cmdUpper == "UNDO") { undo(); return; }
         if (cmdUpper == "REDO") { redo(); return; }
-        if (cmdUpper == "EXIT") { exit(0); }
+        if (cmdUpper == "EXIT") { storage.flush(); exit(0); }
 
         while(!redoStack.empty()) redoStack.pop();
 
@@ -73,6 +77,9 @@ namespace ChronoDB {
         else if (cmd == "UPDATE") handleUpdate(tokens);
         else if (cmd == "DELETE") handleDelete(tokens);
         else if (cmd == "GRAPH") handleGraph(tokens);
+        else if (cmd == "SET") handleSet(tokens);
+        else if (cmd == "VACUUM") handleVacuum(tokens);
+        else if (cmd == "COPY") handleCopy(tokens);
         else Helper::printError("Unknown command: " + cmd);
     }
 
@@ -94,7 +101,7 @@ namespace ChronoDB {
         // Example: CREATE TABLE Products AVL (...)
         if (i < tokens.size() && tokens[i].value != "(") {
             string type = Helper::toUpper(tokens[i].value);
-            if (type == "AVL" || type == "BST" || type == "HASH" || type == "HEAP") {
+            if (type == "AVL" || type == "BST" || type == "HASH" || type == "HEAP" || type == "BTREE" || type == "COLUMNAR") {
                 structureType = type;
                 i++;
             }
@@ -146,11 +153,46 @@ namespace ChronoDB {
                     return;
                 }
                 structureType = Helper::toUpper(tokens[i+1].value);
+                i += 2;
             }
         }
 
-        if (storage.createTable(tableName, columns, structureType)) {
-            Helper::printSuccess("Table '" + tableName + "' created using " + structureType + " (" + to_string(columns.size()) + " columns)");
+        // Optional "COMPACT": smaller rows (varint INTs, no per-field type tags), and
+        // "PAGE_SIZE <bytes | n K>": 4K to 64K, a power of two (default 8K)
+        bool compactRows = false;
+        uint32_t pageSize = DEFAULT_PAGE_SIZE;
+        while (i < tokens.size()) {
+            string option = Helper::toUpper(tokens[i].value);
+            if (option == "COMPACT") {
+                compactRows = true;
+                i++;
+            } else if (option == "PAGE_SIZE") {
+                unsigned long size = 0;
+                try {
+                    size = i + 1 < tokens.size() ? stoul(tokens[i + 1].value) : 0;
+                } catch (...) {
+                    size = 0;
+                }
+                i += 2;
+                if (i < tokens.size() && (Helper::toUpper(tokens[i].value) == "K" || Helper::toUpper(tokens[i].value) == "KB")) {
+                    size *= 1024;
+                    i++;
+                }
+                if (size > MAX_PAGE_SIZE || !isValidPageSize(static_cast<uint32_t>(size))) {
+                    Helper::printError("PAGE_SIZE must be 4K, 8K, 16K, 32K or 64K");
+                    return;
+                }
+                pageSize = static_cast<uint32_t>(size);
+            } else {
+                break;
+            }
+        }
+
+        if (storage.createTable(tableName, columns, structureType, compactRows, pageSize)) {
+            string options = compactRows ? ", compact rows" : "";
+            if (pageSize != DEFAULT_PAGE_SIZE) options += ", " + to_string(pageSize / 1024) + " KB pages";
+            Helper::printSuccess("Table '" + tableName + "' created using " + structureType + " (" + to_string(columns.size()) + " columns" +
+                                 options + ")");
 
             undoStack.push([this, tableName]() {
                 Helper::println("[UNDO] Table removed: " + tableName);
@@ -175,69 +217,112 @@ namespace ChronoDB {
 
         string tableName = tokens[2].value;
 
-        auto columns = storage.getTableColumns(tableName);
-        if (columns.empty()) {
+        const TableInfo* table = storage.getTableInfo(tableName);
+        if (!table || table->columns.empty()) {
             Helper::printError("Table does not exist: " + tableName);
             return;
         }
+        const vector<Column>& columns = table->columns;
 
         size_t expected = columns.size();
         
-        // Collect value tokens, skipping commas and handling parentheses
-        vector<string> values;
+        // Collect value tokens, skipping commas and handling parentheses.
+        // Several rows: VALUES (<v1>, <v2> ...), (<v1>, <v2> ...), ...
+        vector<vector<string>> tuples;
         size_t current = 4;
         bool insideParens = false;
 
         if (current < tokens.size() && tokens[current].value == "(") {
             insideParens = true;
-            current++;
         }
 
-        while (current < tokens.size()) {
-            if (insideParens && tokens[current].value == ")") {
-                current++;
-                break; // End of values
-            }
-            
-            if (tokens[current].value == ",") {
+        do {
+            vector<string> values;
+            if (insideParens) current++; // Consume '('
+
+            while (current < tokens.size()) {
+                if (insideParens && tokens[current].value == ")") {
+                    current++;
+                    break; // End of values
+                }
+                
+                if (tokens[current].value == ",") {
+                    current++;
+                    continue; // Skip commas
+                }
+
+                // Detect if we accidentally hit a new command or something weird (simple check)
+                if (tokens[current].value == ";") break;
+
+                values.push_back(tokens[current].value);
                 current++;
-                continue; // Skip commas
             }
+            tuples.push_back(values);
 
-            // Detect if we accidentally hit a new command or something weird (simple check)
-            if (tokens[current].value == ";") break;
-
-            values.push_back(tokens[current].value);
+            // ", (" starts the next row
+            bool more = insideParens && current + 1 < tokens.size() && tokens[current].value == "," &&
+                        tokens[current + 1].value == "(";
+            if (!more) break;
             current++;
-        }
+        } while (true);
 
-        if (values.size() != expected) {
-            Helper::printError("Expected " + to_string(expected) + " values, got " + to_string(values.size()));
-            return;
-        }
+        vector<Record> rows;
+        for (size_t t = 0; t < tuples.size(); t++) {
+            const vector<string>& values = tuples[t];
+            string where = tuples.size() > 1 ? " in row " + to_string(t + 1) : "";
 
-        Record r;
+            if (values.size() != expected) {
+                Helper::printError("Expected " + to_string(expected) + " values, got " + to_string(values.size()) + where);
+                return;
+            }
 
-        for (size_t i = 0; i < columns.size(); i++) {
-            string value = values[i];
-            string type = columns[i].type;
+            Record r;
 
-            try {
-                if (type == "INT") {
-                    r.fields.push_back(stoi(value));
-                }
-                else if (type == "FLOAT") {
-                    r.fields.push_back(stof(value));
-                }
-                else {
-                    r.fields.push_back(value);
+            for (size_t i = 0; i < columns.size(); i++) {
+                string value = values[i];
+                string type = columns[i].type;
+
+                try {
+                    if (type == "INT") {
+                        r.fields.push_back(stoi(value));
+                    }
+                    else if (type == "FLOAT") {
+                        r.fields.push_back(stof(value));
+                    }
+                    else {
+                        r.fields.push_back(value);
+                    }
+                } catch (...) {
+                    Helper::printError("Type mismatch for column " + columns[i].name + where);
+                    return;
                 }
-            } catch (...) {
-                Helper::printError("Type mismatch for column " + columns[i].name);
+            }
+            rows.push_back(r);
+        }
+
+        if (rows.size() > 1) {
+            // one statement: a single log flush for all the rows
+            size_t stored = storage.insertRecords(tableName, rows);
+            if (stored == 0) {
+                Helper::printError("Failed to insert.");
                 return;
             }
+            if (stored < rows.size()) {
+                Helper::printError("Only the first " + to_string(stored) + " of " + to_string(rows.size()) +
+                                   " records were inserted.");
+                rows.resize(stored);
+            } else {
+                Helper::printSuccess(to_string(rows.size()) + " records inserted.");
+            }
+
+            undoStack.push([this, tableName, rows]() {
+                for (const Record& r : rows) storage.deleteRecord(tableName, get<int>(r.fields[0]));
+                Helper::printSuccess("[UNDO] Removed " + to_string(rows.size()) + " inserted rows");
+            });
+            return;
         }
 
+        Record r = rows[0];
         if (storage.insertRecord(tableName, r)) {
             Helper::printSuccess("Record inserted.");
 
@@ -297,13 +382,14 @@ namespace ChronoDB {
              return;
         }
 
-        auto rows = storage.selectAll(tableName);
-        auto columns = storage.getTableColumns(tableName);
-
-        if (columns.empty()) {
+        const TableInfo* table = storage.getTableInfo(tableName);
+        if (!table || table->columns.empty()) {
             Helper::printError("Table does not exist.");
             return;
         }
+        const vector<Column>& columns = table->columns;
+
+        vector<Record> rows;
 
         // Generic WHERE clause support
         // Syntax: WHERE <col> <op> <val>
@@ -313,20 +399,13 @@ namespace ChronoDB {
             string op = tokens[6].value;
             string valStr = tokens[7].value;
 
-            int colIndex = -1;
-            string colType = "";
-            for(size_t i=0; i<columns.size(); i++) {
-                if(Helper::toUpper(columns[i].name) == Helper::toUpper(colName)) {
-                    colIndex = i;
-                    colType = columns[i].type;
-                    break;
-                }
-            }
-
-            if (colIndex == -1) {
+            optional<size_t> column = table->indexOf(colName);
+            if (!column.has_value()) {
                 Helper::printError("Column not found: " + colName);
                 return;
             }
+            int colIndex = static_cast<int>(*column);
+            string colType = columns[colIndex].type;
 
             // FILTER LOGIC
             // If Range Query (>, <, >=, <=) -> Use Sort + Binary Search
@@ -334,68 +413,74 @@ namespace ChronoDB {
             
             bool isRange = (op == ">" || op == "<" || op == ">=" || op == "<=");
 
-            if (isRange) {
-                // 1. Sort Records
-                // This is O(N log N)
-                Sorting::mergeSort(rows, colIndex, colType);
-                
-                vector<Record> filtered;
-                
-                // 2. Binary Search
-                if (op == ">" || op == ">=") {
-                     // Find first element matching
-                     // For >= val: LowerBound (first element >= val)
-                     // For > val: UpperBound (first element > val)
-                     
-                     int index = -1;
-                     if (op == ">=") index = Sorting::binarySearchLowerBound(rows, colIndex, colType, valStr);
-                     else index = Sorting::binarySearchUpperBound(rows, colIndex, colType, valStr); // >
-                     
-                     // All elements from index to end are matches
-                     for(size_t i = index; i < rows.size(); i++) {
-                         filtered.push_back(rows[i]);
-                     }
-                     
-                } else if (op == "<" || op == "<=") {
-                    // For < val: LowerBound (first element >= val) -> implies everything before is < val
-                    // For <= val: UpperBound (first element > val) -> implies everything before is <= val
-                    
-                    int index = -1;
-                    if (op == "<") index = Sorting::binarySearchLowerBound(rows, colIndex, colType, valStr); // index is start of >= val, so 0..index-1 are < val
-                    else index = Sorting::binarySearchUpperBound(rows, colIndex, colType, valStr); // index is start of > val, so 0..index-1 are <= val
-                    
-                    for(size_t i = 0; i < index && i < rows.size(); i++) {
-                        filtered.push_back(rows[i]);
-                    }
+            if (isRange && colIndex == 0 && colType == "INT") {
+                // Range over the primary key: BTREE tables walk their leaf chain
+                // instead of loading and sorting the whole table
+                long long val = stoll(valStr);
+                long long from = INT_MIN, to = INT_MAX;
+                if (op == ">") from = val + 1;
+                else if (op == ">=") from = val;
+                else if (op == "<") to = val - 1;
+                else to = val;
+                from = max(from, (long long)INT_MIN);
+                to = min(to, (long long)INT_MAX);
+                if (from <= to) rows = storage.selectRange(tableName, (int)from, (int)to);
+
+            } else if (isRange) {
+                // Streamed: each batch is sorted and binary-searched on its own and
+                // only its matches are kept, then the matches are sorted for output
+                TableCursor cursor = storage.openCursor(tableName);
+                vector<Record> batch;
+                while (cursor.next(batch)) {
+                    // 1. Sort Records
+                    // This is O(B log B) per batch of B rows
+                    Sorting::mergeSort(batch, colIndex, colType);
+
+                    // 2. Binary Search
+                    // For >= val: LowerBound (first element >= val), matches run to the end
+                    // For > val: UpperBound (first element > val)
+                    // For < val: LowerBound -> everything before it is < val
+                    // For <= val: UpperBound -> everything before it is <= val
+                    size_t first = 0, last = batch.size();
+                    if (op == ">=") first = Sorting::binarySearchLowerBound(batch, colIndex, colType, valStr);
+                    else if (op == ">") first = Sorting::binarySearchUpperBound(batch, colIndex, colType, valStr);
+                    else if (op == "<") last = Sorting::binarySearchLowerBound(batch, colIndex, colType, valStr);
+                    else last = Sorting::binarySearchUpperBound(batch, colIndex, colType, valStr);
+
+                    move(batch.begin() + first, batch.begin() + last, back_inserter(rows));
                 }
-                
-                rows = filtered;
+                Sorting::mergeSort(rows, colIndex, colType);
 
             } else {
-                // LINEAR SCAN for Equality (=) or others
-                vector<Record> filtered;
-                for(auto& r : rows) {
+                // LINEAR SCAN for Equality (=) or others, one batch at a time.
+                // On the primary key only that id is asked for, so tree structures seek to it.
+                // The column is compared in place (a COLUMNAR table reads only that column
+                // until a row matches); only matching rows are copied out.
+                TableCursor cursor = (colIndex == 0 && colType == "INT" && op == "=")
+                    ? storage.openRangeCursor(tableName, stoi(valStr), stoi(valStr))
+                    : storage.openCursor(tableName);
+                cursor.forEachWhere(colIndex, [&](const RecordView& r) {
                     bool match = false;
-                    
+
                     if (colType == "INT") {
-                        int cell = get<int>(r.fields[colIndex]);
+                        int cell = r.getInt(colIndex);
                         int val = stoi(valStr);
                         if (op == "=") match = (cell == val);
                     }
                     else if (colType == "FLOAT") {
-                        float cell = get<float>(r.fields[colIndex]);
+                        float cell = r.getFloat(colIndex);
                         float val = stof(valStr);
                         if (op == "=") match = (abs(cell - val) < 0.0001);
                     }
                     else if (colType == "STRING") {
-                        string cell = get<string>(r.fields[colIndex]);
+                        string_view cell = r.getString(colIndex);
                         if (op == "=") match = (cell == valStr);
                     }
-
-                    if (match) filtered.push_back(r);
-                }
-                rows = filtered; 
+                    return match;
+                }, [&](const RecordView& r) { rows.push_back(r.toRecord()); });
             }
+        } else {
+            rows = storage.selectAll(tableName);
         }
 
         vector<string> headers;
@@ -436,47 +521,43 @@ namespace ChronoDB {
         string newValue = tokens[4].value;
         int id = stoi(tokens[7].value);
 
-        auto columns = storage.getTableColumns(tableName);
-        auto rows = storage.selectAll(tableName);
-
-        int colIndex = -1;
-        for (size_t i = 0; i < columns.size(); i++) {
-            if (Helper::toUpper(columns[i].name) == Helper::toUpper(field)) {
-                colIndex = i;
-                break;
-            }
-        }
-
-        if (colIndex == -1) {
+        const TableInfo* table = storage.getTableInfo(tableName);
+        optional<size_t> column = table ? table->indexOf(field) : nullopt;
+        if (!column.has_value()) {
             Helper::printError("Field does not exist.");
             return;
         }
+        const vector<Column>& columns = table->columns;
+        size_t colIndex = *column;
+        auto found = storage.findRecord(tableName, id);
 
-        for (auto& rec : rows) {
-            if (get<int>(rec.fields[0]) == id) {
-                Record old = rec;
-
-                if (columns[colIndex].type == "INT")
-                    rec.fields[colIndex] = stoi(newValue);
-                else if (columns[colIndex].type == "FLOAT")
-                    rec.fields[colIndex] = stof(newValue);
-                else
-                    rec.fields[colIndex] = newValue;
+        if (!found.has_value()) {
+            Helper::printError("ID not found.");
+            return;
+        }
 
-                storage.updateRecord(tableName, id, rec);
+        Record rec = *found;
+        Record old = rec;
 
-                undoStack.push([this, tableName, old]() {
-                    int oldId = get<int>(old.fields[0]);
-                    storage.updateRecord(tableName, oldId, old);
-                    Helper::println("[UNDO] Reverted update for ID " + to_string(oldId));
-                });
+        if (columns[colIndex].type == "INT")
+            rec.fields[colIndex] = stoi(newValue);
+        else if (columns[colIndex].type == "FLOAT")
+            rec.fields[colIndex] = stof(newValue);
+        else
+            rec.fields[colIndex] = newValue;
 
-                Helper::printSuccess("Record updated.");
-                return;
-            }
+        if (!storage.updateRecord(tableName, id, rec)) {
+            Helper::printError("Failed to update.");
+            return;
         }
 
-        Helper::printError("ID not found.");
+        undoStack.push([this, tableName, old]() {
+            int oldId = get<int>(old.fields[0]);
+            storage.updateRecord(tableName, oldId, old);
+            Helper::println("[UNDO] Reverted update for ID " + to_string(oldId));
+        });
+
+        Helper::printSuccess("Record updated.");
     }
 
     // ----------------------
@@ -495,23 +576,12 @@ namespace ChronoDB {
         string tableName = tokens[2].value;
         int id = stoi(tokens[5].value);
 
-        auto rows = storage.selectAll(tableName);
-
-        bool found = false;
-        Record deleted;
-
-        for (auto& rec : rows) {
-            if (get<int>(rec.fields[0]) == id) {
-                deleted = rec;
-                found = true;
-                break;
-            }
-        }
-
-        if (!found) {
+        auto found = storage.findRecord(tableName, id);
+        if (!found.has_value()) {
             Helper::printError("ID not found.");
             return;
         }
+        Record deleted = *found;
 
         storage.deleteRecord(tableName, id);
         Helper::printSuccess("Record deleted.");
@@ -522,6 +592,117 @@ namespace ChronoDB {
         });
     }
 
+    // ----------------------
+    // SET (engine options)
+    // ----------------------
+    void Parser::handleSet(const vector<Token>& tokens) {
+        string option = tokens.size() >= 3 ? Helper::toUpper(tokens[1].value) : "";
+        string value = tokens.size() >= 3 ? Helper::toUpper(tokens[2].value) : "";
+
+        // SET AUTOVACUUM ON|OFF
+        if (option == "AUTOVACUUM") {
+            if (value != "ON" && value != "OFF") {
+                Helper::printError("Syntax: SET AUTOVACUUM <ON|OFF>");
+                return;
+            }
+            storage.setAutoVacuum(value == "ON");
+            Helper::printSuccess("Autovacuum " + value);
+            return;
+        }
+
+        // SET DIRECT_IO ON|OFF
+        if (option == "DIRECT_IO") {
+            if (value != "ON" && value != "OFF") {
+                Helper::printError("Syntax: SET DIRECT_IO <ON|OFF>");
+                return;
+            }
+            if (!storage.setDirectIo(value == "ON")) {
+                Helper::printError("Direct I/O is not supported here; table files keep using the OS cache");
+                return;
+            }
+            Helper::printSuccess("Direct I/O " + value);
+            return;
+        }
+
+        // SET DURABILITY SYNC|GROUP|ASYNC
+        if (option != "DURABILITY") {
+            Helper::printError("Syntax: SET DURABILITY <SYNC|GROUP|ASYNC>, SET AUTOVACUUM <ON|OFF> or SET DIRECT_IO <ON|OFF>");
+            return;
+        }
+
+        if (value == "SYNC") storage.setDurabilityMode(DurabilityMode::SYNC);
+        else if (value == "GROUP") storage.setDurabilityMode(DurabilityMode::GROUP);
+        else if (value == "ASYNC") storage.setDurabilityMode(DurabilityMode::ASYNC);
+        else {
+            Helper::printError("Unknown durability mode: " + value);
+            return;
+        }
+        Helper::printSuccess("Durability mode set to " + value);
+    }
+
+    // ----------------------
+    // VACUUM
+    // ----------------------
+    void Parser::handleVacuum(const vector<Token>& tokens) {
+        if (tokens.size() < 2) {
+            Helper::printError("Syntax: VACUUM <table>");
+            return;
+        }
+
+        string tableName = tokens[1].value;
+        auto result = storage.vacuum(tableName);
+        if (!result.has_value()) {
+            Helper::printError("VACUUM needs an existing HEAP table.");
+            return;
+        }
+
+        auto describe = [](const StorageEngine::HeapStats& st) {
+            char line[160];
+            snprintf(line, sizeof(line), "%u pages, fill factor %.1f%%, dead bytes %.1f%% (%llu)",
+                     st.pages, st.fillFactor() * 100.0, st.deadRatio() * 100.0,
+                     static_cast<unsigned long long>(st.deadBytes));
+            return string(line);
+        };
+        Helper::println("Before: " + describe(result->before));
+        Helper::println("After:  " + describe(result->after));
+        Helper::printSuccess("Vacuumed '" + tableName + "': " + to_string(result->pagesCompacted) + " pages compacted, " +
+                             to_string(result->recordsMoved) + " records moved, " +
+                             to_string(result->pagesTruncated) + " pages released.");
+    }
+
+    // ----------------------
+    // COPY (bulk load / export)
+    // ----------------------
+    void Parser::handleCopy(const vector<Token>& tokens) {
+        string direction = tokens.size() >= 4 ? Helper::toUpper(tokens[2].value) : "";
+        if ((direction != "FROM" && direction != "TO") || tokens[3].type != TokenType::STRING_LITERAL) {
+            Helper::printError("Syntax: COPY <table> FROM '<file>' or COPY <table> TO '<file>'");
+            return;
+        }
+
+        string tableName = tokens[1].value;
+        string path = tokens[3].value;
+        if (direction == "TO") {
+            auto rows = storage.exportTable(tableName, path);
+            if (!rows.has_value()) {
+                Helper::printError("Could not export '" + tableName + "' to " + path);
+                return;
+            }
+            Helper::printSuccess("Exported " + to_string(*rows) + " rows to " + path);
+            return;
+        }
+
+        auto result = storage.bulkLoad(tableName, path);
+        if (!result.has_value()) {
+            Helper::printError("COPY needs an existing table with an INT first column and a readable file.");
+            return;
+        }
+        char elapsed[32];
+        snprintf(elapsed, sizeof(elapsed), "%.1f", result->milliseconds);
+        Helper::printSuccess("Loaded " + to_string(result->rowsLoaded) + " rows into '" + tableName + "' in " +
+                             elapsed + " ms (" + to_string(result->rowsRejected) + " rejected).");
+    }
+
     // ----------------------
      // GRAPH COMMANDS
     // ----------------------
@@ -562,38 +743,29 @@ namespace ChronoDB {
             Graph* g = graph.getGraph(graphName);
             if (!g) return; // Error printed by getGraph
 
-           auto rows = storage.selectAll(tableName);
-            auto columns = storage.getTableColumns(tableName);
-            
-            // Find Column Index
-            int colIndex = -1;
-            for(size_t i=0; i<columns.size(); i++) {
-                if(Helper::toUpper(columns[i].name) == Helper::toUpper(colName)) {
-                    colIndex = i;
-                    break;
-                }
-            }
-
-            if (colIndex == -1) {
+            const TableInfo* table = storage.getTableInfo(tableName);
+            optional<size_t> column = table ? table->indexOf(colName) : nullopt;
+            if (!column.has_value()) {
                 Helper::printError("Column not found: " + colName);
                 return;
             }
+            size_t colIndex = *column;
 
-            // Import
+            // Import, streaming the table and reading only the one column
             int count = 0;
-            for(auto& r : rows) {
+            storage.openCursor(tableName).forEach([&](const RecordView& r) {
                 string valStr;
                 // Convert to String for Vertex Name
-                if (holds_alternative<int>(r.fields[colIndex])) 
-                    valStr = to_string(get<int>(r.fields[colIndex]));
-                else if (holds_alternative<float>(r.fields[colIndex]))
-                    valStr = to_string(get<float>(r.fields[colIndex]));
+                if (r.typeTag(colIndex) == TYPE_TAG_INT)
+                    valStr = to_string(r.getInt(colIndex));
+                else if (r.typeTag(colIndex) == TYPE_TAG_FLOAT)
+                    valStr = to_string(r.getFloat(colIndex));
                 else
-                    valStr = get<string>(r.fields[colIndex]);
+                    valStr = string(r.getString(colIndex));
 
                 g->addVertex(valStr);
                 count++;
-            }
+            });
             Helper::printSuccess("Imported " + to_string(count) + " nodes into " + graphName);
         }
         // GRAPH ADDEDGE <graph> <uVal> <vVal> <weight>
@@ -33,6 +33,9 @@ namespace ChronoDB {
         void handleSelect(const std::vector<Token>& tokens);
 
         void handleGraph(const std::vector<Token>& tokens); // NEW
+        void handleSet(const std::vector<Token>& tokens);
+        void handleVacuum(const std::vector<Token>& tokens);
+        void handleCopy(const std::vector<Token>& tokens);
     };
 
 }
@@ -4,6 +4,7 @@
 #include "../../utils/types.h"
 #include <algorithm>
 #include <vector>
+#include <functional>
 #include <optional>
 #include <iostream>
 
@@ -109,6 +110,17 @@ namespace ChronoDB {
             delete node;
         }
 
+        // Middle record becomes the root of each subtree, so the result is balanced without rotations
+        AVLNode* buildBalanced(const std::vector<Record>& sorted, size_t lo, size_t hi) {
+            if (lo >= hi) return nullptr;
+            size_t mid = lo + (hi - lo) / 2;
+            AVLNode* node = new AVLNode(std::get<int>(sorted[mid].fields[0]), sorted[mid]);
+            node->left = buildBalanced(sorted, lo, mid);
+            node->right = buildBalanced(sorted, mid + 1, hi);
+            node->height = 1 + std::max(height(node->left), height(node->right));
+            return node;
+        }
+
     public:
         AVLTree() = default;
         ~AVLTree() { clearHelper(root); }
@@ -133,11 +145,36 @@ namespace ChronoDB {
             return std::nullopt;
         }
 
+        // Replaces the contents with records sorted by (unique, INT) id in O(n)
+        void bulkLoad(const std::vector<Record>& sorted) {
+            clearHelper(root);
+            root = buildBalanced(sorted, 0, sorted.size());
+        }
+
         std::vector<Record> getAllSorted() const {
             std::vector<Record> results;
             inOrderHelper(root, results);
             return results;
         }
+
+        // Visits up to maxRows records with id >= fromId in id order; returns how many.
+        // Seeks in O(log n), so a scan can resume from the last id it returned.
+        size_t visitFrom(int fromId, size_t maxRows, const std::function<void(const Record&)>& visit) const {
+            std::vector<AVLNode*> path; // ancestors still to visit, smallest on top
+            for (AVLNode* node = root; node;) {
+                if (node->id >= fromId) { path.push_back(node); node = node->left; }
+                else node = node->right;
+            }
+            size_t added = 0;
+            while (!path.empty() && added < maxRows) {
+                AVLNode* node = path.back();
+                path.pop_back();
+                visit(node->data);
+                added++;
+                for (AVLNode* n = node->right; n; n = n->left) path.push_back(n);
+            }
+            return added;
+        }
     };
 
 } // namespace ChronoDB
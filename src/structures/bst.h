@@ -6,6 +6,7 @@
 #include <queue>
 #include <stack>
 #include <vector>
+#include <functional>
 #include <optional>
 
 namespace ChronoDB {
@@ -46,6 +47,19 @@ namespace ChronoDB {
             delete node;
         }
 
+        // Middle record becomes the root of each subtree, moved back to the first of
+        // a run of equal ids so equal keys end up on the right, as insert() puts them
+        BSTNode* buildBalanced(const std::vector<Record>& sorted, size_t lo, size_t hi) {
+            if (lo >= hi) return nullptr;
+            size_t mid = lo + (hi - lo) / 2;
+            int id = std::get<int>(sorted[mid].fields[0]);
+            while (mid > lo && std::get<int>(sorted[mid - 1].fields[0]) == id) mid--;
+            BSTNode* node = new BSTNode(id, sorted[mid]);
+            node->left = buildBalanced(sorted, lo, mid);
+            node->right = buildBalanced(sorted, mid + 1, hi);
+            return node;
+        }
+
     public:
         BST() = default;
         ~BST() { clearHelper(root); }
@@ -134,6 +148,74 @@ namespace ChronoDB {
             inOrderHelper(root, results);
             return results;
         }
+
+        // Replaces the contents with records sorted by (INT) id in O(n), balanced
+        // (sorted inserts would build a list)
+        void bulkLoad(const std::vector<Record>& sorted) {
+            clearHelper(root);
+            root = buildBalanced(sorted, 0, sorted.size());
+        }
+
+        // Visits up to maxRows records with id >= fromId in id order (equal ids in
+        // insertion order); returns how many. Walks only the path to fromId first.
+        size_t visitFrom(int fromId, size_t maxRows, const std::function<void(const Record&)>& visit) const {
+            std::vector<BSTNode*> path; // ancestors still to visit, smallest on top
+            for (BSTNode* node = root; node;) {
+                if (node->id >= fromId) { path.push_back(node); node = node->left; }
+                else node = node->right;
+            }
+            size_t added = 0;
+            while (!path.empty() && added < maxRows) {
+                BSTNode* node = path.back();
+                path.pop_back();
+                visit(node->data);
+                added++;
+                for (BSTNode* n = node->right; n; n = n->left) path.push_back(n);
+            }
+            return added;
+        }
+
+        // Pre-order listing: enough to rebuild the exact same shape with loadPreOrder
+        std::vector<Record> getAllPreOrder() const {
+            std::vector<Record> results;
+            std::stack<BSTNode*> s;
+            if (root) s.push(root);
+            while (!s.empty()) {
+                BSTNode* current = s.top();
+                s.pop();
+                results.push_back(current->data);
+                if (current->right) s.push(current->right);
+                if (current->left) s.push(current->left);
+            }
+            return results;
+        }
+
+        // Rebuilds the tree from a pre-order listing in O(n) (each node is pushed and
+        // popped once) instead of n root-to-leaf inserts. The stack holds the nodes
+        // still waiting for a right child.
+        void loadPreOrder(const std::vector<Record>& preorder) {
+            clearHelper(root);
+            root = nullptr;
+            std::stack<BSTNode*> open;
+            for (const Record& rec : preorder) {
+                int id = std::get<int>(rec.fields[0]);
+                BSTNode* node = new BSTNode(id, rec);
+                if (!root) {
+                    root = node;
+                } else if (id < open.top()->id) {
+                    open.top()->left = node;
+                } else {
+                    // right child of the deepest ancestor whose key is <= id (equal keys go right)
+                    BSTNode* parent = nullptr;
+                    while (!open.empty() && open.top()->id <= id) {
+                        parent = open.top();
+                        open.pop();
+                    }
+                    parent->right = node;
+                }
+                open.push(node);
+            }
+        }
     };
 
 } // namespace ChronoDB
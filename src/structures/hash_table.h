@@ -3,7 +3,10 @@
 
 #include "../../utils/types.h"
 #include <list>
+#include <algorithm>
+#include <iterator>
 #include <vector>
+#include <functional>
 #include <optional>
 #include <iostream>
 
@@ -61,6 +64,24 @@ namespace ChronoDB {
             }
             return results;
         }
+
+        // Visits up to maxRows records in getAll() order, starting at entry `position`
+        // of chain `bucket`, and moves (bucket, position) past them; returns how many
+        size_t visitFrom(size_t& bucket, size_t& position, size_t maxRows,
+                         const std::function<void(const Record&)>& visit) const {
+            size_t added = 0;
+            while (bucket < table.size() && added < maxRows) {
+                const auto& chain = table[bucket];
+                auto it = chain.begin();
+                std::advance(it, std::min(position, chain.size()));
+                for (; it != chain.end() && added < maxRows; ++it, ++position) {
+                    visit(it->data);
+                    added++;
+                }
+                if (it == chain.end()) { bucket++; position = 0; }
+            }
+            return added;
+        }
     };
 
 } // namespace ChronoDB
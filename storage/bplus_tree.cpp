@@ -0,0 +1,487 @@
+// bplus_tree.cpp
+#include "bplus_tree.h"
+#include <cstring>
+#include <memory>
+#include <algorithm>
+using namespace std;
+
+namespace ChronoDB {
+
+    // Node header (page bytes 24..63)
+    static constexpr uint16_t NODE_TYPE_OFFSET = PAGE_AUX_OFFSET;       // u8
+    static constexpr uint16_t NODE_LINK_OFFSET = PAGE_AUX_OFFSET + 4;   // u32: right sibling / leftmost child
+    static constexpr uint8_t NODE_LEAF = 1;
+    static constexpr uint8_t NODE_INTERNAL = 2;
+
+    // Meta page (page 0) header
+    static constexpr uint32_t TREE_MAGIC = 0x31545042; // "BPT1"
+    static constexpr uint16_t META_MAGIC_OFFSET = PAGE_AUX_OFFSET;
+    static constexpr uint16_t META_ROOT_OFFSET = PAGE_AUX_OFFSET + 4;
+    static constexpr uint16_t META_LEVELS_OFFSET = PAGE_AUX_OFFSET + 8;
+    static constexpr uint16_t META_CLEAN_OFFSET = PAGE_AUX_OFFSET + 10;
+
+    static constexpr uint32_t NO_PAGE = 0; // page 0 is the meta page, never a node
+    static constexpr uint32_t INTERNAL_ENTRY_BYTES = 8;
+    // Bulk-loaded nodes are left 10% empty so the first inserts do not split them
+    static uint32_t bulkFillBytes(const Page& p) { return (p.size() - PAGE_HEADER_RESERVED) * 9 / 10; }
+
+    // ---------- node helpers ----------
+    static uint8_t nodeType(const Page& p) { return p.data[NODE_TYPE_OFFSET]; }
+
+    static uint32_t nodeLink(const Page& p) {
+        uint32_t v = 0;
+        memcpy(&v, p.data.data() + NODE_LINK_OFFSET, 4);
+        return v;
+    }
+
+    static void setNodeLink(Page& p, uint32_t v) {
+        memcpy(p.data.data() + NODE_LINK_OFFSET, &v, 4);
+    }
+
+    static int32_t keyAt(const Page& p, uint16_t i) {
+        int32_t k = 0;
+        memcpy(&k, p.data.data() + p.slot(i).offset, 4);
+        return k;
+    }
+
+    static uint32_t childAt(const Page& p, uint16_t i) {
+        uint32_t c = 0;
+        memcpy(&c, p.data.data() + p.slot(i).offset + 4, 4);
+        return c;
+    }
+
+    // First slot whose key is >= key (orEqual=false) or > key (orEqual=true)
+    static uint16_t searchSlots(const Page& p, int32_t key, bool orEqual) {
+        uint16_t lo = 0, hi = p.slotCount();
+        while (lo < hi) {
+            uint16_t mid = (lo + hi) / 2;
+            int32_t k = keyAt(p, mid);
+            if (k < key || (orEqual && k == key)) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+    // Child of an internal node covering key: separators <= key are passed on the right
+    static uint32_t childFor(const Page& p, int32_t key) {
+        uint16_t n = searchSlots(p, key, true);
+        return n == 0 ? nodeLink(p) : childAt(p, n - 1);
+    }
+
+    static vector<uint8_t> makeEntry(int32_t key, const uint8_t* value, size_t len) {
+        vector<uint8_t> e(4 + len);
+        memcpy(e.data(), &key, 4);
+        if (len) memcpy(e.data() + 4, value, len);
+        return e;
+    }
+
+    static vector<uint8_t> makeInternalEntry(int32_t key, uint32_t child) {
+        return makeEntry(key, reinterpret_cast<const uint8_t*>(&child), sizeof(child));
+    }
+
+    static void formatNode(Page& p, uint32_t pageIndex, uint8_t type, uint32_t link) {
+        uint64_t lsn = p.pageLSN();
+        p.reset();
+        p.setPageID(pageIndex);
+        p.setPageLSN(lsn);
+        p.data[NODE_TYPE_OFFSET] = type;
+        setNodeLink(p, link);
+    }
+
+    // Inserts bytes as slot pos (compacting first when that makes room)
+    static bool insertSlot(Page& p, uint16_t pos, const vector<uint8_t>& bytes) {
+        uint32_t need = static_cast<uint32_t>(bytes.size() + SLOT_ENTRY_BYTES);
+        if (p.freeSpace() < need) {
+            if (p.freeSpace() + p.deadBytes() < need) return false;
+            p.compact();
+        }
+        uint16_t len = static_cast<uint16_t>(bytes.size());
+        uint16_t offset = p.freeSpaceOffset();
+        memcpy(p.data.data() + offset, bytes.data(), len);
+        p.insertSlot(pos, SlotEntry(offset, len, SLOT_LIVE));
+        p.setFreeSpaceOffset(static_cast<uint16_t>(offset + len));
+        return true;
+    }
+
+    static vector<uint8_t> slotBytes(const Page& p, uint16_t i) {
+        SlotEntry e = p.slot(i);
+        return vector<uint8_t>(p.data.begin() + e.offset, p.data.begin() + e.offset + e.length);
+    }
+
+    static void fillNode(Page& p, const vector<vector<uint8_t>>& entries, size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) insertSlot(p, p.slotCount(), entries[i]);
+    }
+
+    // ---------- BPlusTree ----------
+    BPlusTree::BPlusTree(BufferPool& bufferPool, const string& fileKey, PageAllocator allocator, ChangeLogger changeLogger)
+        : pool(bufferPool), file(fileKey), allocate(move(allocator)), logger(move(changeLogger)) {}
+
+    bool BPlusTree::open(uint32_t filePages) {
+        if (filePages >= 2) {
+            PageHandle meta(pool, file, 0);
+            uint32_t magic = 0;
+            if (meta.valid()) {
+                maxValue = maxValueBytes(meta->size());
+                memcpy(&magic, meta->data.data() + META_MAGIC_OFFSET, 4);
+            }
+            if (magic == TREE_MAGIC) {
+                memcpy(&root, meta->data.data() + META_ROOT_OFFSET, 4);
+                memcpy(&levels, meta->data.data() + META_LEVELS_OFFSET, 2);
+                clean = meta->data[META_CLEAN_OFFSET] != 0;
+                return true;
+            }
+        }
+
+        // format: meta page 0 and an empty root leaf on page 1
+        while (filePages < 2) {
+            if (!allocate()) return false;
+            filePages++;
+        }
+        root = 1;
+        levels = 1;
+        clean = false;
+        PageHandle meta(pool, file, 0, true);
+        PageHandle leaf(pool, file, 1, true);
+        if (!meta.valid() || !leaf.valid()) return false;
+        maxValue = maxValueBytes(meta->size());
+        meta->reset();
+        writeMeta(*meta);
+        formatNode(*leaf, 1, NODE_LEAF, NO_PAGE);
+        meta.markDirty();
+        leaf.markDirty();
+        logChange(Change::IMAGE, {{0, &*meta}, {1, &*leaf}});
+        return false;
+    }
+
+    void BPlusTree::writeMeta(Page& meta) const {
+        meta.setPageID(0);
+        memcpy(meta.data.data() + META_MAGIC_OFFSET, &TREE_MAGIC, 4);
+        memcpy(meta.data.data() + META_ROOT_OFFSET, &root, 4);
+        memcpy(meta.data.data() + META_LEVELS_OFFSET, &levels, 2);
+        meta.data[META_CLEAN_OFFSET] = clean ? 1 : 0;
+    }
+
+    void BPlusTree::setClean(bool value) {
+        clean = value;
+        PageHandle meta(pool, file, 0);
+        if (!meta.valid()) return;
+        writeMeta(*meta);
+        meta.markDirty();
+    }
+
+    void BPlusTree::logChange(Change change, const ChangedPages& pages, const vector<uint8_t>& payload) {
+        if (logger) logger(change, pages, payload);
+    }
+
+    // Walks from the root to the leaf covering key, remembering the internal nodes passed
+    uint32_t BPlusTree::findLeaf(int32_t key, vector<uint32_t>* path) {
+        uint32_t node = root;
+        for (uint16_t depth = 0; depth <= levels; ++depth) {
+            PageHandle p(pool, file, node);
+            if (!p.valid()) return NO_PAGE;
+            if (nodeType(*p) != NODE_INTERNAL) return node;
+            if (path) path->push_back(node);
+            node = childFor(*p, key);
+        }
+        return NO_PAGE; // deeper than the tree's height: corrupt
+    }
+
+    optional<vector<uint8_t>> BPlusTree::get(int32_t key) {
+        uint32_t leafIndex = findLeaf(key, nullptr);
+        if (leafIndex == NO_PAGE) return nullopt;
+        PageHandle leaf(pool, file, leafIndex);
+        if (!leaf.valid()) return nullopt;
+        uint16_t i = searchSlots(*leaf, key, false);
+        if (i >= leaf->slotCount() || keyAt(*leaf, i) != key) return nullopt;
+        SlotEntry e = leaf->slot(i);
+        return vector<uint8_t>(leaf->data.begin() + e.offset + 4, leaf->data.begin() + e.offset + e.length);
+    }
+
+    // Down the rightmost path; every key left of a separator on it is smaller
+    optional<int32_t> BPlusTree::maxKeyBound() {
+        optional<int32_t> bound;
+        uint32_t node = root;
+        for (uint16_t depth = 0; depth <= levels; ++depth) {
+            PageHandle p(pool, file, node);
+            if (!p.valid()) return INT32_MAX;
+            uint16_t n = p->slotCount();
+            if (nodeType(*p) != NODE_INTERNAL) return n ? keyAt(*p, n - 1) : bound;
+            if (n) bound = keyAt(*p, n - 1);
+            node = n ? childAt(*p, n - 1) : nodeLink(*p);
+        }
+        return INT32_MAX; // corrupt: promise nothing
+    }
+
+    bool BPlusTree::leafPut(Page& leaf, int32_t key, const vector<uint8_t>& value) {
+        vector<uint8_t> entry = makeEntry(key, value.data(), value.size());
+        uint16_t i = searchSlots(leaf, key, false);
+        if (i < leaf.slotCount() && keyAt(leaf, i) == key) {
+            uint16_t oldLength = leaf.slot(i).length;
+            if (entry.size() <= oldLength || leaf.freeSpace() >= entry.size()) return leaf.replaceRecord(i, entry);
+            if (leaf.freeSpace() + leaf.deadBytes() + oldLength < entry.size()) return false;
+            leaf.eraseSlot(i);
+            leaf.compact();
+        }
+        return insertSlot(leaf, i, entry);
+    }
+
+    bool BPlusTree::leafRemove(Page& leaf, int32_t key) {
+        uint16_t i = searchSlots(leaf, key, false);
+        if (i >= leaf.slotCount() || keyAt(leaf, i) != key) return false;
+        leaf.eraseSlot(i);
+        return true;
+    }
+
+    bool BPlusTree::put(int32_t key, const vector<uint8_t>& value) {
+        if (value.size() > maxValue) return false;
+        vector<uint32_t> path;
+        uint32_t leafIndex = findLeaf(key, &path);
+        if (leafIndex == NO_PAGE) return false;
+        {
+            PageHandle leaf(pool, file, leafIndex);
+            if (!leaf.valid()) return false;
+            if (leafPut(*leaf, key, value)) {
+                leaf.markDirty();
+                logChange(Change::LEAF_PUT, {{leafIndex, &*leaf}}, makeEntry(key, value.data(), value.size()));
+                return true;
+            }
+        }
+        return split(path, leafIndex, key, value);
+    }
+
+    // Splits the full leaf (adding key/value) and pushes separators up as far as
+    // needed. Every page involved stays pinned until the whole change is logged.
+    bool BPlusTree::split(vector<uint32_t>& path, uint32_t leafIndex, int32_t key, const vector<uint8_t>& value) {
+        vector<unique_ptr<PageHandle>> touched;
+        auto pin = [&](uint32_t index, bool fresh) -> Page* {
+            for (auto& h : touched)
+                if (h->pageIndex() == index) return &**h;
+            auto h = make_unique<PageHandle>(pool, file, index, fresh);
+            if (!h->valid()) return nullptr;
+            h->markDirty();
+            touched.push_back(move(h));
+            return &**touched.back();
+        };
+        auto logTouched = [&]() {
+            ChangedPages pages;
+            for (auto& h : touched) pages.emplace_back(h->pageIndex(), &**h);
+            logChange(Change::IMAGE, pages);
+        };
+
+        // every page the split needs is allocated before a node changes: the new
+        // leaf, a sibling for each full ancestor, and a new root if they all are
+        size_t needed = 1;
+        for (size_t i = path.size();; --i) {
+            if (i == 0) {
+                needed++;
+                break;
+            }
+            PageHandle ancestor(pool, file, path[i - 1]);
+            if (!ancestor.valid()) return false;
+            if (ancestor->freeSpace() + ancestor->deadBytes() >= INTERNAL_ENTRY_BYTES + SLOT_ENTRY_BYTES) break;
+            needed++;
+        }
+        vector<uint32_t> newPages;
+        while (newPages.size() < needed) {
+            optional<uint32_t> index = allocate();
+            if (!index.has_value()) return false;
+            newPages.push_back(*index);
+        }
+        size_t nextNew = 0;
+
+        Page* leaf = pin(leafIndex, false);
+        if (!leaf) return false;
+
+        // the leaf's entries in key order with the new one merged in
+        vector<vector<uint8_t>> entries;
+        vector<uint8_t> added = makeEntry(key, value.data(), value.size());
+        bool placed = false;
+        for (uint16_t i = 0; i < leaf->slotCount(); ++i) {
+            int32_t k = keyAt(*leaf, i);
+            if (!placed && key <= k) {
+                entries.push_back(added);
+                placed = true;
+                if (k == key) continue;
+            }
+            entries.push_back(slotBytes(*leaf, i));
+        }
+        if (!placed) entries.push_back(added);
+
+        // split by bytes so both halves fit whatever the entry sizes
+        size_t total = 0;
+        for (const auto& e : entries) total += e.size() + SLOT_ENTRY_BYTES;
+        size_t mid = 0, leftBytes = 0;
+        while (mid + 1 < entries.size() && leftBytes + entries[mid].size() + SLOT_ENTRY_BYTES <= total / 2) {
+            leftBytes += entries[mid].size() + SLOT_ENTRY_BYTES;
+            mid++;
+        }
+        if (mid == 0) mid = 1;
+
+        uint32_t rightIndex = newPages[nextNew++];
+        Page* right = pin(rightIndex, true);
+        if (!right) return false;
+        formatNode(*right, rightIndex, NODE_LEAF, nodeLink(*leaf));
+        fillNode(*right, entries, mid, entries.size());
+        formatNode(*leaf, leafIndex, NODE_LEAF, rightIndex);
+        fillNode(*leaf, entries, 0, mid);
+
+        int32_t separator = 0;
+        memcpy(&separator, entries[mid].data(), 4);
+        uint32_t left = leafIndex, newChild = rightIndex;
+
+        for (;;) {
+            if (path.empty()) {
+                // the root split: grow the tree by one level
+                uint32_t rootIndex = newPages[nextNew++];
+                Page* newRoot = pin(rootIndex, true);
+                Page* meta = pin(0, false);
+                if (!newRoot || !meta) return false;
+                formatNode(*newRoot, rootIndex, NODE_INTERNAL, left);
+                insertSlot(*newRoot, 0, makeInternalEntry(separator, newChild));
+                root = rootIndex;
+                levels++;
+                writeMeta(*meta);
+                break;
+            }
+
+            uint32_t parentIndex = path.back();
+            path.pop_back();
+            Page* parent = pin(parentIndex, false);
+            if (!parent) return false;
+            vector<uint8_t> entry = makeInternalEntry(separator, newChild);
+            uint16_t pos = searchSlots(*parent, separator, true);
+            if (insertSlot(*parent, pos, entry)) break;
+
+            // internal split: the middle separator moves up, its child leads the new node
+            vector<vector<uint8_t>> inner;
+            for (uint16_t i = 0; i < parent->slotCount(); ++i) {
+                if (i == pos) inner.push_back(entry);
+                inner.push_back(slotBytes(*parent, i));
+            }
+            if (pos == parent->slotCount()) inner.push_back(entry);
+
+            size_t half = inner.size() / 2;
+            int32_t upKey = 0;
+            uint32_t upChild = 0;
+            memcpy(&upKey, inner[half].data(), 4);
+            memcpy(&upChild, inner[half].data() + 4, 4);
+
+            uint32_t siblingIndex = newPages[nextNew++];
+            Page* sibling = pin(siblingIndex, true);
+            if (!sibling) return false;
+            formatNode(*sibling, siblingIndex, NODE_INTERNAL, upChild);
+            fillNode(*sibling, inner, half + 1, inner.size());
+            uint32_t firstChild = nodeLink(*parent);
+            formatNode(*parent, parentIndex, NODE_INTERNAL, firstChild);
+            fillNode(*parent, inner, 0, half);
+
+            left = parentIndex;
+            separator = upKey;
+            newChild = siblingIndex;
+        }
+
+        logTouched();
+        return true;
+    }
+
+    bool BPlusTree::remove(int32_t key) {
+        uint32_t leafIndex = findLeaf(key, nullptr);
+        if (leafIndex == NO_PAGE) return false;
+        PageHandle leaf(pool, file, leafIndex);
+        if (!leaf.valid() || !leafRemove(*leaf, key)) return false;
+        leaf.markDirty();
+        logChange(Change::LEAF_REMOVE, {{leafIndex, &*leaf}}, makeEntry(key, nullptr, 0));
+        return true;
+    }
+
+    void BPlusTree::scan(int32_t from, int32_t to, const Visitor& visit) {
+        uint32_t node = findLeaf(from, nullptr);
+        bool first = true;
+        while (node != NO_PAGE) {
+            PageHandle p(pool, file, node);
+            if (!p.valid()) return;
+            uint16_t i = first ? searchSlots(*p, from, false) : 0;
+            first = false;
+            for (; i < p->slotCount(); ++i) {
+                int32_t k = keyAt(*p, i);
+                if (k > to) return;
+                SlotEntry e = p->slot(i);
+                if (!visit(k, p->data.data() + e.offset + 4, static_cast<uint16_t>(e.length - 4))) return;
+            }
+            node = nodeLink(*p);
+        }
+    }
+
+    bool BPlusTree::bulkLoad(const vector<pair<int32_t, vector<uint8_t>>>& sorted) {
+        if (levels != 1) return false;
+        {
+            PageHandle r(pool, file, root);
+            if (!r.valid() || r->slotCount() != 0) return false;
+        }
+        if (sorted.empty()) return true;
+
+        // 1. leaves, left to right; the first one is the current (empty) root
+        vector<pair<int32_t, uint32_t>> level; // (first key, page) of each node on the level
+        uint32_t current = root;
+        auto node = make_unique<PageHandle>(pool, file, current);
+        level.emplace_back(sorted[0].first, current);
+        uint32_t used = 0;
+        for (const auto& kv : sorted) {
+            if (kv.second.size() > maxValue) return false;
+            vector<uint8_t> entry = makeEntry(kv.first, kv.second.data(), kv.second.size());
+            uint32_t need = static_cast<uint32_t>(entry.size() + SLOT_ENTRY_BYTES);
+            if (used + need > bulkFillBytes(**node) && (*node)->slotCount() != 0) {
+                optional<uint32_t> allocated = allocate();
+                if (!allocated.has_value()) return false;
+                uint32_t next = *allocated;
+                setNodeLink(**node, next);
+                node->markDirty();
+                logChange(Change::IMAGE, {{current, &**node}});
+                node = make_unique<PageHandle>(pool, file, next, true);
+                if (!node->valid()) return false;
+                formatNode(**node, next, NODE_LEAF, NO_PAGE);
+                current = next;
+                used = 0;
+                level.emplace_back(kv.first, next);
+            }
+            insertSlot(**node, (*node)->slotCount(), entry);
+            used += need;
+        }
+        node->markDirty();
+        logChange(Change::IMAGE, {{current, &**node}});
+        node.reset();
+
+        // 2. internal levels until a single node is left
+        while (level.size() > 1) {
+            vector<pair<int32_t, uint32_t>> parents;
+            size_t i = 0;
+            while (i < level.size()) {
+                optional<uint32_t> allocated = allocate();
+                if (!allocated.has_value()) return false;
+                uint32_t index = *allocated;
+                PageHandle p(pool, file, index, true);
+                if (!p.valid()) return false;
+                formatNode(*p, index, NODE_INTERNAL, level[i].second);
+                parents.emplace_back(level[i].first, index);
+                uint32_t bytes = 0;
+                for (++i; i < level.size() && bytes + INTERNAL_ENTRY_BYTES + SLOT_ENTRY_BYTES <= bulkFillBytes(*p); ++i) {
+                    insertSlot(*p, p->slotCount(), makeInternalEntry(level[i].first, level[i].second));
+                    bytes += INTERNAL_ENTRY_BYTES + SLOT_ENTRY_BYTES;
+                }
+                p.markDirty();
+                logChange(Change::IMAGE, {{index, &*p}});
+            }
+            level = move(parents);
+            levels++;
+        }
+
+        root = level[0].second;
+        PageHandle meta(pool, file, 0);
+        if (!meta.valid()) return false;
+        writeMeta(*meta);
+        meta.markDirty();
+        logChange(Change::IMAGE, {{0, &*meta}});
+        return true;
+    }
+
+} // namespace ChronoDB
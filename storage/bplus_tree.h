@@ -0,0 +1,95 @@
+#ifndef CHRONODB_BPLUS_TREE_H
+#define CHRONODB_BPLUS_TREE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <functional>
+#include "page.h"
+#include "buffer_pool.h"
+using namespace std;
+
+namespace ChronoDB {
+
+    // Paged B+Tree from INT keys to byte strings, kept in slotted pages (of the
+    // file's page size) behind the buffer pool. Each node is a Page whose slots
+    // are kept in key order, so a node is searched with a binary search over its
+    // slot directory:
+    //   leaf:     slot = [key i32][value], right sibling in the node header
+    //   internal: slot = [key i32][child u32], leftmost child in the node header
+    // Leaves are linked left to right for range scans. Page 0 is the meta page.
+    // Deletes do not rebalance: an emptied leaf stays in the chain.
+    class BPlusTree {
+    public:
+        // What a change did, for callers that write-ahead log the tree
+        enum class Change {
+            LEAF_PUT,     // one leaf; payload = key + value, redo with leafPut()
+            LEAF_REMOVE,  // one leaf; payload = key, redo with leafRemove()
+            IMAGE         // split or new root: every page involved, to be logged as one unit
+        };
+        using ChangedPages = vector<pair<uint32_t, Page*>>;
+        using ChangeLogger = function<void(Change change, const ChangedPages& pages, const vector<uint8_t>& payload)>;
+        // Appends a blank page to the tree's file and returns its index (nullopt if it could not)
+        using PageAllocator = function<optional<uint32_t>()>;
+        using Visitor = function<bool(int32_t key, const uint8_t* value, uint16_t len)>;
+
+        // Largest value a tree with pages of pageSize bytes takes: a leaf holds at
+        // least three entries, so both halves of a split by bytes always fit
+        static size_t maxValueBytes(uint32_t pageSize) {
+            return (pageSize - PAGE_HEADER_RESERVED) / 3 - 4 - SLOT_ENTRY_BYTES;
+        }
+
+        BPlusTree(BufferPool& pool, const string& fileKey, PageAllocator allocator, ChangeLogger logger = nullptr);
+
+        // Loads the meta page of a file with filePages pages. A file without a valid
+        // tree is formatted as an empty one; returns false in that case.
+        bool open(uint32_t filePages);
+
+        optional<vector<uint8_t>> get(int32_t key);
+        // Insert or replace
+        bool put(int32_t key, const vector<uint8_t>& value);
+        bool remove(int32_t key);
+        // Visits from <= key <= to in key order until the visitor returns false
+        void scan(int32_t from, int32_t to, const Visitor& visit);
+        // No key in the tree is greater than this (the largest key, or a separator
+        // above an emptied last leaf); nullopt for an empty tree. One descent.
+        optional<int32_t> maxKeyBound();
+        // Fills an empty tree from entries sorted by key: leaves are packed left to
+        // right and every internal level is built from the one below, O(n)
+        bool bulkLoad(const vector<pair<int32_t, vector<uint8_t>>>& sorted);
+
+        uint16_t height() const { return levels; }
+        // maxValueBytes() for the page size of this tree's file
+        size_t valueLimit() const { return maxValue; }
+
+        // Written on disk once every page of the tree is; trees found without it
+        // after a crash are rebuilt by their owner
+        bool isClean() const { return clean; }
+        void setClean(bool value);
+
+        // Single-page leaf changes, also used to redo logged ones. They leave the
+        // page untouched and return false when it has no room.
+        static bool leafPut(Page& leaf, int32_t key, const vector<uint8_t>& value);
+        static bool leafRemove(Page& leaf, int32_t key);
+
+    private:
+        BufferPool& pool;
+        string file;
+        PageAllocator allocate;
+        ChangeLogger logger;
+
+        uint32_t root = 0;
+        uint16_t levels = 0;
+        bool clean = false;
+        size_t maxValue = maxValueBytes(DEFAULT_PAGE_SIZE);
+
+        uint32_t findLeaf(int32_t key, vector<uint32_t>* path);
+        bool split(vector<uint32_t>& path, uint32_t leafIndex, int32_t key, const vector<uint8_t>& value);
+        void writeMeta(Page& meta) const;
+        void logChange(Change change, const ChangedPages& pages, const vector<uint8_t>& payload = {});
+    };
+
+} // namespace ChronoDB
+
+#endif // CHRONODB_BPLUS_TREE_H
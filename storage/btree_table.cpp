@@ -0,0 +1,124 @@
+// btree_table.cpp
+#include "storage.h"
+#include <cstring>
+using namespace std;
+
+namespace ChronoDB {
+
+    // ---------- BTREE tables ----------
+    // The .tbl file of a BTREE table is a BPlusTree from the INT primary key to the
+    // serialised record, so lookups read one page per level and range scans follow
+    // the leaf chain. Unlike the primary-key index every change is write-ahead
+    // logged: single-leaf changes as BTREE_PUT / BTREE_REMOVE, and each split as
+    // one BTREE_IMAGES record holding all its pages, so redo never sees half a split.
+
+    BPlusTree* StorageEngine::btreeTable(const string& tableName) {
+        auto it = btreeTables.find(tableName);
+        if (it != btreeTables.end()) return it->second.get();
+        if (getStructureType(tableName) != StructureType::BTREE) return nullptr;
+
+        PagedFile* file = tableFile(tableName, true);
+        if (!file) return nullptr;
+        auto tree = make_unique<BPlusTree>(
+            bufferPool, tableName,
+            [this, tableName]() { return appendEmptyPage(tableName); },
+            [this, tableName](BPlusTree::Change change, const BPlusTree::ChangedPages& pages, const vector<uint8_t>& payload) {
+                logTreeChange(tableName, change, pages, payload);
+            });
+        tree->open(file->pageCount());
+        BPlusTree* raw = tree.get();
+        btreeTables[tableName] = move(tree);
+        return raw;
+    }
+
+    // BTREE_IMAGES payload: count u32, then per page: pageIndex u32 + page image
+    // (of the table's page size)
+    void StorageEngine::logTreeChange(const string& tableName, BPlusTree::Change change,
+                                      const BPlusTree::ChangedPages& pages, const vector<uint8_t>& payload) {
+        if (pages.empty()) return;
+        if (change != BPlusTree::Change::IMAGE) {
+            LogType type = change == BPlusTree::Change::LEAF_PUT ? LogType::BTREE_PUT : LogType::BTREE_REMOVE;
+            pages[0].second->setPageLSN(logHeapOp(type, tableName, pages[0].first, 0, payload.data(), payload.size()));
+            return;
+        }
+
+        uint32_t count = static_cast<uint32_t>(pages.size());
+        size_t pageSize = pages[0].second->size();
+        vector<uint8_t> images(4 + static_cast<size_t>(count) * (4 + pageSize));
+        memcpy(images.data(), &count, 4);
+        size_t pos = 4;
+        for (const auto& entry : pages) {
+            memcpy(images.data() + pos, &entry.first, 4);
+            entry.second->serializeToBuffer(images.data() + pos + 4);
+            pos += 4 + pageSize;
+        }
+        uint64_t lsn = logHeapOp(LogType::BTREE_IMAGES, tableName, pages[0].first, 0, images.data(), images.size());
+        for (const auto& entry : pages) entry.second->setPageLSN(lsn);
+    }
+
+    void StorageEngine::redoTreeImages(const LogRecord& rec) {
+        PagedFile* file = tableFile(rec.table, true);
+        if (!file || rec.payload.size() < 4) return;
+        uint32_t count = 0;
+        memcpy(&count, rec.payload.data(), 4);
+        size_t pageSize = file->pageSize();
+        if (rec.payload.size() < 4 + static_cast<size_t>(count) * (4 + pageSize)) return;
+
+        for (uint32_t i = 0; i < count; ++i) {
+            const uint8_t* entry = rec.payload.data() + 4 + static_cast<size_t>(i) * (4 + pageSize);
+            uint32_t pageIndex = 0;
+            memcpy(&pageIndex, entry, 4);
+            while (file->pageCount() <= pageIndex)
+                if (!appendEmptyPage(rec.table)) return;
+
+            PageHandle p(bufferPool, rec.table, pageIndex);
+            if (!p.valid() || p->pageLSN() >= rec.lsn) continue;
+            p->deserializeFromBuffer(entry + 4);
+            p->setPageLSN(rec.lsn);
+            p.markDirty();
+        }
+    }
+
+    bool StorageEngine::insertTreeRecord(const string& tableName, const Record& rec) {
+        const TableInfo* table = catalog.find(tableName);
+        if (!table || !table->matches(rec)) return false;
+        if (rec.fields.empty() || !holds_alternative<int>(rec.fields[0])) return false;
+
+        BPlusTree* tree = btreeTable(tableName);
+        vector<uint8_t> bytes;
+        if (!table->codec.encode(rec, bytes)) return false;
+        // upsert, like HEAP inserts
+        return tree && tree->put(get<int>(rec.fields[0]), bytes);
+    }
+
+    bool StorageEngine::updateTreeRecord(const string& tableName, int id, const Record& newRecord) {
+        if (newRecord.fields.empty() || !holds_alternative<int>(newRecord.fields[0])) return false;
+        BPlusTree* tree = btreeTable(tableName);
+        if (!tree || !tree->get(id).has_value()) return false;
+
+        vector<uint8_t> bytes;
+        if (!codecFor(tableName).encode(newRecord, bytes)) return false;
+        if (bytes.size() > tree->valueLimit()) return false;
+        int newId = get<int>(newRecord.fields[0]);
+        // the new key must not be another row's, as in HEAP updates
+        if (newId != id && tree->get(newId).has_value()) return false;
+        // the new key goes in first, so a failed put leaves the old row in place
+        if (!tree->put(newId, bytes)) return false;
+        return newId == id || tree->remove(id);
+    }
+
+    bool StorageEngine::deleteTreeRecord(const string& tableName, int id) {
+        BPlusTree* tree = btreeTable(tableName);
+        return tree && tree->remove(id);
+    }
+
+    optional<Record> StorageEngine::findTreeRecord(const string& tableName, int id) {
+        BPlusTree* tree = btreeTable(tableName);
+        if (!tree) return nullopt;
+        optional<vector<uint8_t>> bytes = tree->get(id);
+        Record rec;
+        if (!bytes.has_value() || !codecFor(tableName).decode(*bytes, rec)) return nullopt;
+        return rec;
+    }
+
+} // namespace ChronoDB
@@ -0,0 +1,223 @@
+// buffer_pool.cpp
+#include "buffer_pool.h"
+#include <algorithm>
+#include <optional>
+using namespace std;
+
+namespace ChronoDB {
+
+    BufferPool::BufferPool(size_t memoryBudgetBytes, PageReader reader, PageWriter writer)
+        : readPage(move(reader)), writePage(move(writer)) {
+        budget = max(memoryBudgetBytes, MIN_BUFFER_POOL_FRAMES * DEFAULT_PAGE_SIZE);
+    }
+
+    Page* BufferPool::fetchPage(const string& table, uint32_t pageIndex) {
+        return pinFrame({table, pageIndex}, true);
+    }
+
+    Page* BufferPool::newPage(const string& table, uint32_t pageIndex) {
+        return pinFrame({table, pageIndex}, false);
+    }
+
+    Page* BufferPool::pinFrame(const PageKey& key, bool loadFromDisk) {
+        auto it = pageTable.find(key);
+        if (it != pageTable.end()) {
+            Frame& f = *frames[it->second];
+            if (f.pinCount++ == 0 && logTail) f.pinLSN = logTail();
+            f.referenced = true;
+            hitCount++;
+            if (!loadFromDisk) f.page.reset();
+            return &f.page;
+        }
+
+        size_t idx = 0;
+        if (!acquireFrame(pageSizer ? pageSizer(key.table) : DEFAULT_PAGE_SIZE, idx)) return nullptr;
+
+        Frame& f = *frames[idx];
+        if (loadFromDisk) {
+            // the file's image lands in the frame as is
+            missCount++;
+            if (!readPage(key.table, key.pageIndex, f.page)) return nullptr;
+        } else {
+            f.page.reset();
+        }
+        f.key = key;
+        f.pinCount = 1;
+        f.pinLSN = logTail ? logTail() : 0;
+        f.dirty = false;
+        f.referenced = true;
+        f.valid = true;
+        pageTable[key] = idx;
+        return &f.page;
+    }
+
+    void BufferPool::unpinPage(const string& table, uint32_t pageIndex, bool dirty) {
+        auto it = pageTable.find({table, pageIndex});
+        if (it == pageTable.end()) return;
+        Frame& f = *frames[it->second];
+        if (f.pinCount > 0) f.pinCount--;
+        if (dirty && !f.dirty) {
+            f.dirty = true;
+            f.recLSN = f.pinLSN;
+            dirtyCount++;
+            dirtyBytes += f.page.size();
+        }
+
+        // Write dirty pages back as one batch once half of the pool is dirty
+        if (dirtyBytes * 2 > budget) {
+            vector<size_t> batch;
+            for (size_t i = 0; i < frames.size(); ++i)
+                if (frames[i]->valid && frames[i]->dirty && frames[i]->pinCount == 0) batch.push_back(i);
+            flushFrames(batch);
+        }
+    }
+
+    // Returns an empty frame holding a page of pageBytes: a new one while under
+    // budget, otherwise CLOCK victims until the page fits (the first victim, unless
+    // it holds a smaller page than the one coming in)
+    bool BufferPool::acquireFrame(uint32_t pageBytes, size_t& frameIndex) {
+        if (frameBytes + pageBytes <= budget || frames.size() < MIN_BUFFER_POOL_FRAMES) {
+            if (!emptyFrames.empty()) {
+                frameIndex = emptyFrames.back();
+                emptyFrames.pop_back();
+                frames[frameIndex]->page.reset(pageBytes);
+            } else {
+                frames.push_back(make_unique<Frame>(pageBytes));
+                frameIndex = frames.size() - 1;
+            }
+            frameBytes += pageBytes;
+            return true;
+        }
+
+        // Two full sweeps: the first clears reference bits, the second finds the victims
+        optional<size_t> chosen;
+        for (size_t step = 0; step < frames.size() * 2; ++step) {
+            Frame& f = *frames[clockHand];
+            size_t current = clockHand;
+            clockHand = (clockHand + 1) % frames.size();
+
+            if (f.page.size() == 0 || (chosen && current == *chosen)) continue;
+            if (f.valid) {
+                if (f.pinCount > 0) continue;
+                if (f.referenced) { f.referenced = false; continue; }
+                if (f.dirty && !writeBack(f)) continue;
+                pageTable.erase(f.key);
+                f.valid = false;
+            }
+            if (!chosen) {
+                chosen = current;
+            } else {
+                // a further victim only gives its memory back
+                frameBytes -= f.page.size();
+                f.page.data = PageBuffer();
+                emptyFrames.push_back(current);
+            }
+            if (frameBytes - frames[*chosen]->page.size() + pageBytes <= budget) break;
+        }
+        if (!chosen) return false;
+
+        Frame& f = *frames[*chosen];
+        if (f.page.size() != pageBytes) {
+            frameBytes = frameBytes - f.page.size() + pageBytes;
+            f.page.reset(pageBytes);
+        }
+        frameIndex = *chosen;
+        return true;
+    }
+
+    bool BufferPool::writeBack(Frame& f) {
+        if (!f.dirty) return true;
+        if (!writePage(f.key.table, f.key.pageIndex, f.page)) return false;
+        f.dirty = false;
+        dirtyCount--;
+        dirtyBytes -= f.page.size();
+        return true;
+    }
+
+    // Writes a set of frames ordered by (table, page) so each file is written sequentially
+    void BufferPool::flushFrames(vector<size_t> frameIndexes) {
+        sort(frameIndexes.begin(), frameIndexes.end(), [&](size_t a, size_t b) {
+            const PageKey& ka = frames[a]->key;
+            const PageKey& kb = frames[b]->key;
+            if (ka.table != kb.table) return ka.table < kb.table;
+            return ka.pageIndex < kb.pageIndex;
+        });
+        for (size_t i : frameIndexes) writeBack(*frames[i]);
+    }
+
+    bool BufferPool::flushPage(const string& table, uint32_t pageIndex) {
+        auto it = pageTable.find({table, pageIndex});
+        if (it == pageTable.end()) return true;
+        return writeBack(*frames[it->second]);
+    }
+
+    void BufferPool::flushTable(const string& table) {
+        vector<size_t> batch;
+        for (size_t i = 0; i < frames.size(); ++i)
+            if (frames[i]->valid && frames[i]->dirty && frames[i]->key.table == table) batch.push_back(i);
+        flushFrames(batch);
+    }
+
+    void BufferPool::flushAll() {
+        vector<size_t> batch;
+        for (size_t i = 0; i < frames.size(); ++i)
+            if (frames[i]->valid && frames[i]->dirty) batch.push_back(i);
+        flushFrames(batch);
+    }
+
+    void BufferPool::flushOlderThan(uint64_t lsn) {
+        vector<size_t> batch;
+        for (size_t i = 0; i < frames.size(); ++i)
+            if (frames[i]->valid && frames[i]->dirty && frames[i]->recLSN < lsn) batch.push_back(i);
+        flushFrames(batch);
+    }
+
+    vector<pair<PageKey, uint64_t>> BufferPool::dirtyPageTable() const {
+        vector<pair<PageKey, uint64_t>> dpt;
+        for (const auto& fp : frames)
+            if (fp->valid && fp->dirty) dpt.emplace_back(fp->key, fp->recLSN);
+        return dpt;
+    }
+
+    void BufferPool::discardPages(const string& table, uint32_t firstPage) {
+        for (auto& fp : frames) {
+            Frame& f = *fp;
+            if (!f.valid || f.key.table != table || f.key.pageIndex < firstPage || f.pinCount > 0) continue;
+            if (f.dirty) {
+                dirtyCount--;
+                dirtyBytes -= f.page.size();
+            }
+            pageTable.erase(f.key);
+            f.valid = false;
+            f.dirty = false;
+        }
+    }
+
+    void BufferPool::setMemoryBudget(size_t bytes) {
+        budget = max(bytes, MIN_BUFFER_POOL_FRAMES * DEFAULT_PAGE_SIZE);
+        if (frameBytes > budget) {
+            // Shrink: write everything back and drop the frames that are neither
+            // pinned nor still dirty (their write-back failed or had to wait for the log)
+            flushAll();
+            vector<unique_ptr<Frame>> kept;
+            frameBytes = 0;
+            dirtyCount = 0;
+            dirtyBytes = 0;
+            for (auto& fp : frames) {
+                if (!fp->valid || (fp->pinCount == 0 && !fp->dirty)) continue;
+                frameBytes += fp->page.size();
+                if (fp->dirty) {
+                    dirtyCount++;
+                    dirtyBytes += fp->page.size();
+                }
+                kept.push_back(move(fp));
+            }
+            frames = move(kept);
+            emptyFrames.clear();
+            pageTable.clear();
+            for (size_t i = 0; i < frames.size(); ++i) pageTable[frames[i]->key] = i;
+            clockHand = 0;
+        }
+    }
+
+} // namespace ChronoDB
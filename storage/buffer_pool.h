@@ -0,0 +1,150 @@
+#ifndef CHRONODB_BUFFER_POOL_H
+#define CHRONODB_BUFFER_POOL_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include "page.h"
+using namespace std;
+
+namespace ChronoDB {
+
+    // Default memory budget for cached table pages (32 MB = 4096 frames of 8 KB)
+    static constexpr size_t DEFAULT_BUFFER_POOL_BYTES = 32u * 1024u * 1024u;
+    // A B+Tree split keeps up to two pages per level (plus the meta page) pinned
+    static constexpr size_t MIN_BUFFER_POOL_FRAMES = 16;
+
+    // Identifies one page of one table file
+    struct PageKey {
+        string table;
+        uint32_t pageIndex = 0;
+
+        bool operator==(const PageKey& o) const { return pageIndex == o.pageIndex && table == o.table; }
+    };
+
+    struct PageKeyHash {
+        size_t operator()(const PageKey& k) const {
+            return hash<string>()(k.table) ^ (static_cast<size_t>(k.pageIndex) * 0x9E3779B97F4A7C15ull);
+        }
+    };
+
+    // Page frames between the StorageEngine and the .tbl files, within a memory
+    // budget. A frame holds a page of its file's page size (tables choose theirs),
+    // so the budget is counted in bytes. Frames are pinned while in use, dirty
+    // frames are written back in batches (on eviction, when half the budget is
+    // dirty, or on an explicit flush) and victims are chosen with the CLOCK
+    // (second chance) policy.
+    class BufferPool {
+    public:
+        using PageReader = function<bool(const string& table, uint32_t pageIndex, Page& out)>;
+        using PageWriter = function<bool(const string& table, uint32_t pageIndex, const Page& page)>;
+        using LogTail = function<uint64_t()>;
+        using PageSizer = function<uint32_t(const string& table)>;
+
+        BufferPool(size_t memoryBudgetBytes, PageReader reader, PageWriter writer);
+
+        // Pins the page, reading it from disk on a miss. Returns nullptr when every frame is pinned.
+        Page* fetchPage(const string& table, uint32_t pageIndex);
+        // Pins a frame for a page that is about to be overwritten completely (no disk read)
+        Page* newPage(const string& table, uint32_t pageIndex);
+        void unpinPage(const string& table, uint32_t pageIndex, bool dirty);
+
+        bool flushPage(const string& table, uint32_t pageIndex);
+        void flushTable(const string& table);
+        void flushAll();
+        // Writes back the dirty pages whose first unflushed change is older than lsn
+        void flushOlderThan(uint64_t lsn);
+        // Drops the cached pages of a table from firstPage on without writing them back (file truncated)
+        void discardPages(const string& table, uint32_t firstPage);
+
+        // Source of the current end-of-log LSN, used to stamp each dirty page with a
+        // recovery LSN (no change to the page before it can be missing from disk)
+        void setLogTail(LogTail tail) { logTail = move(tail); }
+        // Page size of each file (DEFAULT_PAGE_SIZE for every file when not set)
+        void setPageSizer(PageSizer sizer) { pageSizer = move(sizer); }
+        // Dirty page table for checkpoints: (page, recLSN)
+        vector<pair<PageKey, uint64_t>> dirtyPageTable() const;
+
+        void setMemoryBudget(size_t bytes);
+        size_t memoryBudget() const { return budget; }
+        // Bytes held by frames (never much over the budget)
+        size_t residentBytes() const { return frameBytes; }
+        size_t residentPages() const { return pageTable.size(); }
+        bool isResident(const string& table, uint32_t pageIndex) const { return pageTable.count({table, pageIndex}) != 0; }
+        size_t dirtyPages() const { return dirtyCount; }
+
+        // Stats (hits are fetches served without disk I/O)
+        uint64_t hits() const { return hitCount; }
+        uint64_t misses() const { return missCount; }
+
+    private:
+        struct Frame {
+            explicit Frame(uint32_t pageBytes) : page(pageBytes) {}
+            PageKey key;
+            Page page;
+            int pinCount = 0;
+            bool dirty = false;
+            bool referenced = false;
+            bool valid = false;
+            uint64_t pinLSN = 0;  // log tail when the current pin started
+            uint64_t recLSN = 0;  // log tail when the frame went from clean to dirty
+        };
+
+        PageReader readPage;
+        PageWriter writePage;
+        LogTail logTail;
+        PageSizer pageSizer;
+
+        size_t budget;
+        size_t frameBytes = 0;             // page bytes of every frame
+        vector<unique_ptr<Frame>> frames;
+        vector<size_t> emptyFrames;        // frames whose page was given up to make room
+        unordered_map<PageKey, size_t, PageKeyHash> pageTable;
+        size_t clockHand = 0;
+        size_t dirtyCount = 0;
+        size_t dirtyBytes = 0;
+        uint64_t hitCount = 0;
+        uint64_t missCount = 0;
+
+        Page* pinFrame(const PageKey& key, bool loadFromDisk);
+        bool acquireFrame(uint32_t pageBytes, size_t& frameIndex);
+        bool writeBack(Frame& f);
+        void flushFrames(vector<size_t> frameIndexes);
+    };
+
+    // RAII pin on a buffer pool page; unpins (optionally dirty) when it goes out of scope
+    class PageHandle {
+    public:
+        PageHandle(BufferPool& pool, const string& table, uint32_t pageIndex, bool fresh = false)
+            : bp(&pool), tableName(table), index(pageIndex) {
+            pg = fresh ? pool.newPage(table, pageIndex) : pool.fetchPage(table, pageIndex);
+        }
+        ~PageHandle() { release(); }
+        PageHandle(const PageHandle&) = delete;
+        PageHandle& operator=(const PageHandle&) = delete;
+
+        bool valid() const { return pg != nullptr; }
+        uint32_t pageIndex() const { return index; }
+        Page* operator->() { return pg; }
+        Page& operator*() { return *pg; }
+        void markDirty() { dirty = true; }
+
+        void release() {
+            if (pg) bp->unpinPage(tableName, index, dirty);
+            pg = nullptr;
+        }
+
+    private:
+        BufferPool* bp;
+        string tableName;
+        uint32_t index;
+        Page* pg = nullptr;
+        bool dirty = false;
+    };
+
+} // namespace ChronoDB
+
+#endif // CHRONODB_BUFFER_POOL_H
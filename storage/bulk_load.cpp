@@ -0,0 +1,472 @@
+// bulk_load.cpp
+#include "storage.h"
+#include <future>
+#include <deque>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+using namespace std;
+
+namespace ChronoDB {
+
+    // ---------- Bulk load (COPY) ----------
+    // The file is read in chunks cut at row boundaries. Each chunk is parsed (and
+    // for HEAP / BTREE tables encoded with the table's codec) on a worker thread
+    // while the loading thread stores the chunks before it, in file order, so
+    // parsing overlaps with building pages. HEAP rows are packed into new pages
+    // that are written once and logged as one PAGE_IMAGE each; BTREE, AVL and BST
+    // tables are built bottom-up from the sorted rows at the end.
+    //
+    // Binary format: magic | column count u16 | TYPE_TAG_* per column, then per
+    // row a u32 length and the row in the TAGGED format.
+
+    static constexpr char COPY_MAGIC[8] = {'C', 'D', 'B', 'C', 'O', 'P', 'Y', '1'};
+    static constexpr size_t LOAD_CHUNK_BYTES = 4 * 1024 * 1024;
+
+    namespace {
+        struct LoadChunk {
+            vector<Record> rows;                             // AVL / BST / HASH / COLUMNAR
+            vector<pair<int32_t, vector<uint8_t>>> encoded;  // HEAP / BTREE: id + row in the table's format
+            uint64_t rejected = 0;
+        };
+    }
+
+    // Calls row(fields) for each line of CSV text. Quoted fields may hold commas,
+    // newlines and "" for a quote; blank lines are skipped.
+    template <typename RowFn>
+    static void forEachCsvRow(const char* p, const char* end, RowFn row) {
+        vector<string> fields;
+        string field;
+        bool quoted = false, any = false;
+        auto endRow = [&]() {
+            if (!field.empty() && field.back() == '\r') field.pop_back();
+            if (any || !field.empty()) {
+                fields.push_back(move(field));
+                row(fields);
+            }
+            fields.clear();
+            field.clear();
+            any = false;
+        };
+        for (; p < end; ++p) {
+            char c = *p;
+            if (quoted) {
+                if (c != '"') field += c;
+                else if (p + 1 < end && p[1] == '"') field += *++p;
+                else quoted = false;
+            } else if (c == '"') {
+                quoted = any = true;
+            } else if (c == ',') {
+                fields.push_back(move(field));
+                field.clear();
+                any = true;
+            } else if (c == '\n') {
+                endRow();
+            } else {
+                field += c;
+            }
+        }
+        endRow();
+    }
+
+    // Length of the prefix made of whole rows (CSV: up to the last newline outside quotes)
+    static size_t wholeRows(const string& data, bool binary) {
+        size_t cut = 0;
+        if (binary) {
+            while (data.size() - cut >= 4) {
+                uint32_t len = 0;
+                memcpy(&len, data.data() + cut, 4);
+                if (data.size() - cut - 4 < len) break;
+                cut += 4 + len;
+            }
+            return cut;
+        }
+        bool quoted = false;
+        for (size_t i = 0; i < data.size(); ++i) {
+            if (data[i] == '"') quoted = !quoted;
+            else if (data[i] == '\n' && !quoted) cut = i + 1;
+        }
+        return cut;
+    }
+
+    static bool parseValue(uint8_t typeTag, string& text, RecordValue& out) {
+        if (typeTag == TYPE_TAG_STRING) {
+            out = move(text);
+            return true;
+        }
+        const char* s = text.c_str();
+        char* end = nullptr;
+        errno = 0;
+        if (typeTag == TYPE_TAG_INT) {
+            long long v = strtoll(s, &end, 10);
+            if (v < INT_MIN || v > INT_MAX) return false;
+            out = static_cast<int>(v);
+        } else {
+            out = strtof(s, &end);
+        }
+        while (end != s && *end == ' ') ++end;
+        return end != s && *end == '\0' && errno == 0;
+    }
+
+    // Runs on a worker thread: reads only the table's schema and codec
+    static LoadChunk parseChunk(const TableInfo& table, const string& data, bool binary, bool encode) {
+        LoadChunk chunk;
+        auto add = [&](Record& rec) {
+            if (!table.matches(rec)) {
+                chunk.rejected++;
+                return;
+            }
+            if (!encode) {
+                chunk.rows.push_back(move(rec));
+                return;
+            }
+            vector<uint8_t> bytes;
+            size_t limit = table.structure == StructureType::BTREE ? BPlusTree::maxValueBytes(table.pageSize)
+                                                                    : table.pageSize - PAGE_HEADER_RESERVED - SLOT_ENTRY_BYTES;
+            if (!table.codec.encode(rec, bytes) || bytes.size() > limit) {
+                chunk.rejected++;
+                return;
+            }
+            chunk.encoded.emplace_back(get<int>(rec.fields[0]), move(bytes));
+        };
+
+        Record rec;
+        if (binary) {
+            const uint8_t* in = reinterpret_cast<const uint8_t*>(data.data());
+            size_t pos = 0;
+            while (data.size() - pos >= 4) {
+                uint32_t len = 0;
+                memcpy(&len, in + pos, 4);
+                if (data.size() - pos - 4 < len) break;
+                if (RecordCodec::decodeTagged(in + pos + 4, len, rec)) add(rec);
+                else chunk.rejected++;
+                pos += 4 + len;
+            }
+            if (pos < data.size()) chunk.rejected++; // cut-off last row
+            return chunk;
+        }
+
+        forEachCsvRow(data.data(), data.data() + data.size(), [&](vector<string>& fields) {
+            rec.fields.clear();
+            if (fields.size() != table.typeTags.size()) {
+                chunk.rejected++;
+                return;
+            }
+            for (size_t i = 0; i < fields.size(); ++i) {
+                RecordValue v;
+                if (!parseValue(table.typeTags[i], fields[i], v)) {
+                    chunk.rejected++;
+                    return;
+                }
+                rec.fields.push_back(move(v));
+            }
+            add(rec);
+        });
+        return chunk;
+    }
+
+    // A first CSV line that names the table's columns in order
+    static bool isHeader(const TableInfo& table, const string& line) {
+        bool header = false;
+        forEachCsvRow(line.data(), line.data() + line.size(), [&](vector<string>& fields) {
+            if (fields.size() != table.columns.size()) return;
+            header = true;
+            for (size_t i = 0; i < fields.size(); ++i)
+                header = header && table.indexOf(fields[i]) == optional<size_t>(i);
+        });
+        return header;
+    }
+
+    optional<StorageEngine::LoadResult> StorageEngine::bulkLoad(const string& tableName, const string& path) {
+        auto start = chrono::steady_clock::now();
+        const TableInfo* table = getTableInfo(tableName);
+        if (!table || table->typeTags.empty() || table->typeTags[0] != TYPE_TAG_INT) return nullopt;
+        ifstream in(path, ios::binary);
+        if (!in) return nullopt;
+
+        string pending; // read, not yet handed to a worker
+        char magic[sizeof(COPY_MAGIC)] = {};
+        in.read(magic, sizeof(magic));
+        bool binary = in.gcount() == sizeof(magic) && memcmp(magic, COPY_MAGIC, sizeof(magic)) == 0;
+        if (binary) {
+            uint16_t columns = 0;
+            in.read(reinterpret_cast<char*>(&columns), 2);
+            vector<uint8_t> tags(columns);
+            in.read(reinterpret_cast<char*>(tags.data()), columns);
+            if (!in || tags != table->typeTags) return nullopt;
+        } else {
+            pending.assign(magic, static_cast<size_t>(in.gcount()));
+            in.clear();
+        }
+
+        StructureType type = table->structure;
+        bool encode = type == StructureType::HEAP || type == StructureType::BTREE;
+        bool sortAtEnd = type == StructureType::BTREE || type == StructureType::AVL || type == StructureType::BST;
+        vector<pair<int32_t, vector<uint8_t>>> treeRows;
+        vector<Record> orderedRows;
+        LoadResult result;
+
+        // store one parsed chunk; the engine lock is taken per chunk so other
+        // statements run in between
+        auto store = [&](LoadChunk& chunk) {
+            result.rowsRejected += chunk.rejected;
+            if (type == StructureType::BTREE) {
+                move(chunk.encoded.begin(), chunk.encoded.end(), back_inserter(treeRows));
+                return;
+            }
+            if (type == StructureType::AVL || type == StructureType::BST) {
+                move(chunk.rows.begin(), chunk.rows.end(), back_inserter(orderedRows));
+                return;
+            }
+            unique_lock<recursive_mutex> lock(engineMutex);
+            if (!openTable(tableName)) return;
+            size_t stored = 0;
+            if (type == StructureType::HEAP) {
+                stored = bulkLoadHeap(tableName, chunk.encoded);
+                commitWrite(lock);
+            } else if (type == StructureType::HASH) {
+                for (const Record& rec : chunk.rows) hashTables[tableName].insert(rec);
+                stored = chunk.rows.size();
+                dirtySnapshots.insert(tableName);
+            } else {
+                for (const Record& rec : chunk.rows) stored += insertColumnarRecord(tableName, rec);
+            }
+            size_t given = encode ? chunk.encoded.size() : chunk.rows.size();
+            result.rowsLoaded += stored;
+            result.rowsRejected += given - stored;
+        };
+
+        size_t workers = max(2u, thread::hardware_concurrency());
+        deque<future<LoadChunk>> inFlight;
+        vector<char> buffer(LOAD_CHUNK_BYTES);
+        bool eof = false, firstChunk = !binary;
+        while (!eof || !inFlight.empty()) {
+            while (!eof && inFlight.size() < workers) {
+                in.read(buffer.data(), buffer.size());
+                pending.append(buffer.data(), static_cast<size_t>(in.gcount()));
+                eof = !in;
+                size_t cut = eof ? pending.size() : wholeRows(pending, binary);
+                if (cut == 0) continue;
+                string data = pending.substr(0, cut);
+                pending.erase(0, cut);
+                if (firstChunk) {
+                    size_t lineEnd = data.find('\n');
+                    if (lineEnd != string::npos && isHeader(*table, data.substr(0, lineEnd))) data.erase(0, lineEnd + 1);
+                    firstChunk = false;
+                }
+                inFlight.push_back(async(launch::async, parseChunk, cref(*table), move(data), binary, encode));
+            }
+            if (inFlight.empty()) break;
+            LoadChunk chunk = inFlight.front().get();
+            inFlight.pop_front();
+            store(chunk);
+        }
+
+        if (sortAtEnd) {
+            unique_lock<recursive_mutex> lock(engineMutex);
+            if (openTable(tableName)) {
+                size_t given = type == StructureType::BTREE ? treeRows.size() : orderedRows.size();
+                size_t stored = type == StructureType::BTREE ? bulkLoadTree(tableName, treeRows)
+                                                             : bulkLoadOrdered(tableName, orderedRows);
+                result.rowsLoaded += stored;
+                result.rowsRejected += given - stored;
+                if (type == StructureType::BTREE) commitWrite(lock);
+            }
+        }
+        if (!encode) {
+            // the in-memory structures reach disk only through their snapshots
+            lock_guard<recursive_mutex> lock(engineMutex);
+            checkpoint();
+        }
+        result.milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+    // Appends the rows in order, filling pages one after another: first the
+    // table's last page while they fit (through the buffer pool, each row logged
+    // as INSERT logs it), then new pages packed after it. Each new page is logged
+    // as a single PAGE_IMAGE; the log is made durable once for all of them, then
+    // the pages are written and indexed. A row whose id is already in the table
+    // (or earlier in the batch) replaces that row, which is removed only once the
+    // new one is on disk. Stops at the first row it cannot store, so the rows
+    // stored are always the first ones and nothing else is lost.
+    size_t StorageEngine::bulkLoadHeap(const string& tableName, const vector<pair<int32_t, vector<uint8_t>>>& rows) {
+        BPlusTree* index = primaryIndexForWrite(tableName);
+        PagedFile* file = tableFile(tableName);
+        if (rows.empty() || !index || !file || file->pageCount() == 0) return 0;
+        // ids above every indexed one (the usual case for appended data) need no lookup
+        optional<int32_t> indexedMax = index->maxKeyBound();
+        uint32_t lastPage = file->pageCount() - 1;
+        uint32_t firstPage = lastPage + 1;
+        PageHandle last(bufferPool, tableName, lastPage);
+        bool topUp = last.valid();
+        vector<Page> pages;
+        unordered_map<int32_t, RecordLocation> placed; // rows of this batch, by id
+        struct NewRow {
+            int32_t id;
+            RecordLocation loc;
+            optional<RecordLocation> replaces; // removed once this row is on disk
+        };
+        vector<NewRow> order; // rows on the new pages in file order
+        size_t onLastPage = 0;
+
+        for (const auto& row : rows) {
+            optional<RecordLocation> old;
+            auto same = placed.find(row.first);
+            if (same != placed.end()) old = same->second;
+            else if (indexedMax.has_value() && row.first <= *indexedMax) old = locateRecord(tableName, row.first);
+            if (topUp) {
+                optional<uint16_t> slot = last->insertRawRecord(row.second);
+                if (slot.has_value()) {
+                    last->setPageLSN(logHeapOp(LogType::HEAP_INSERT, tableName, lastPage, *slot, row.second.data(),
+                                               row.second.size()));
+                    last.markDirty();
+                    if (old.has_value() && !removeRecordAt(tableName, *old)) {
+                        last->deleteSlot(*slot);
+                        last->setPageLSN(logHeapOp(LogType::HEAP_DELETE, tableName, lastPage, *slot, nullptr, 0));
+                        deadBytesSinceVacuum[tableName] += row.second.size();
+                        break;
+                    }
+                    placed[row.first] = RecordLocation{lastPage, *slot};
+                    indexPut(tableName, row.first, placed[row.first]);
+                    onLastPage++;
+                    continue;
+                }
+                topUp = false;
+            }
+            optional<uint16_t> slot;
+            if (!pages.empty()) slot = pages.back().insertRawRecord(row.second);
+            if (!slot.has_value()) {
+                pages.emplace_back(file->pageSize());
+                pages.back().setPageID(firstPage + static_cast<uint32_t>(pages.size()) - 1);
+                slot = pages.back().insertRawRecord(row.second);
+                if (!slot.has_value()) {
+                    pages.pop_back();
+                    break;
+                }
+            }
+            RecordLocation loc{pages.back().pageID(), *slot};
+            if (old.has_value() && old->pageIndex == loc.pageIndex) {
+                // both rows are on the same new page, so they are stored or lost together
+                deadBytesSinceVacuum[tableName] += pages.back().slot(old->slotID).length;
+                pages.back().deleteSlot(old->slotID);
+                old.reset();
+            }
+            placed[row.first] = loc;
+            order.push_back(NewRow{row.first, loc, old});
+        }
+        FreeSpaceMap* fsm = freeSpaceMap(tableName);
+        if (last.valid()) fsm->update(lastPage, last->freeSpace());
+        last.release();
+        if (pages.empty()) return onLastPage;
+
+        for (Page& page : pages) logPageImage(tableName, page.pageID(), page);
+        if (!wal.flushTo(pages.back().pageLSN())) return onLastPage;
+
+        uint32_t written = 0;
+        for (const Page& page : pages) {
+            if (!writePageToDisk(tableName, page.pageID(), page)) break;
+            fsm->update(page.pageID(), page.freeSpace());
+            written++;
+        }
+        uint32_t end = firstPage + written;
+        if (written < pages.size()) {
+            // the pages that did not make it are cut off again, in the log as well,
+            // so recovery does not bring their rows back
+            wal.flushTo(logHeapOp(LogType::TABLE_TRUNCATE, tableName, end, 0, nullptr, 0));
+            file->truncate(end);
+            fsm->resize(end);
+        }
+        // in file order, so ascending ids keep landing on the same index leaf
+        size_t stored = onLastPage;
+        for (const NewRow& row : order) {
+            if (row.loc.pageIndex >= end) break;
+            stored++;
+            if (row.replaces.has_value()) removeRecordAt(tableName, *row.replaces);
+            indexPut(tableName, row.id, row.loc);
+        }
+        return stored;
+    }
+
+    // Later rows win over earlier ones with the same id (a put replaces). An empty
+    // tree is built bottom-up with every page full; otherwise the sorted rows are put
+    // one by one, which keeps consecutive puts on the same leaf.
+    size_t StorageEngine::bulkLoadTree(const string& tableName, vector<pair<int32_t, vector<uint8_t>>>& rows) {
+        BPlusTree* tree = btreeTable(tableName);
+        if (!tree || rows.empty()) return 0;
+        size_t given = rows.size();
+        stable_sort(rows.begin(), rows.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        size_t kept = 0;
+        for (size_t i = 0; i < rows.size(); ++i) {
+            if (kept > 0 && rows[kept - 1].first == rows[i].first) rows[kept - 1] = move(rows[i]);
+            else if (kept++ != i) rows[kept - 1] = move(rows[i]);
+        }
+        rows.resize(kept);
+
+        bool empty = tree->height() == 1;
+        if (empty) {
+            tree->scan(INT_MIN, INT_MAX, [&](int32_t, const uint8_t*, uint16_t) {
+                empty = false;
+                return false;
+            });
+        }
+        if (empty) {
+            if (!tree->bulkLoad(rows)) return 0;
+        } else {
+            for (const auto& row : rows) tree->put(row.first, row.second);
+        }
+        return given;
+    }
+
+    // AVL and BST tables are rebuilt balanced from their current rows merged with
+    // the new ones, in O(n log n) for the sort instead of n root-to-leaf inserts.
+    // AVL keeps the first row of an id, like its inserts; BST keeps them all.
+    size_t StorageEngine::bulkLoadOrdered(const string& tableName, vector<Record>& rows) {
+        if (rows.empty()) return 0;
+        auto byId = [](const Record& a, const Record& b) { return get<int>(a.fields[0]) < get<int>(b.fields[0]); };
+        stable_sort(rows.begin(), rows.end(), byId);
+        bool avl = getStructureType(tableName) == StructureType::AVL;
+        vector<Record> current = avl ? avlTables[tableName].getAllSorted() : bstTables[tableName].getAllSorted();
+        vector<Record> merged;
+        merged.reserve(current.size() + rows.size());
+        merge(make_move_iterator(current.begin()), make_move_iterator(current.end()),
+              make_move_iterator(rows.begin()), make_move_iterator(rows.end()), back_inserter(merged), byId);
+        if (avl) {
+            merged.erase(unique(merged.begin(), merged.end(),
+                                [](const Record& a, const Record& b) { return get<int>(a.fields[0]) == get<int>(b.fields[0]); }),
+                         merged.end());
+            avlTables[tableName].bulkLoad(merged);
+        } else {
+            bstTables[tableName].bulkLoad(merged);
+        }
+        dirtySnapshots.insert(tableName);
+        return rows.size();
+    }
+
+    optional<uint64_t> StorageEngine::exportTable(const string& tableName, const string& path) {
+        const TableInfo* table = getTableInfo(tableName);
+        if (!table || table->columns.empty()) return nullopt;
+        ofstream out(path, ios::binary | ios::trunc);
+        if (!out) return nullopt;
+        uint16_t columns = static_cast<uint16_t>(table->typeTags.size());
+        out.write(COPY_MAGIC, sizeof(COPY_MAGIC));
+        out.write(reinterpret_cast<const char*>(&columns), 2);
+        out.write(reinterpret_cast<const char*>(table->typeTags.data()), columns);
+
+        uint64_t rows = 0;
+        vector<uint8_t> bytes;
+        openCursor(tableName).forEach([&](const RecordView& r) {
+            RecordCodec::encodeTagged(r.toRecord(), bytes);
+            uint32_t len = static_cast<uint32_t>(bytes.size());
+            out.write(reinterpret_cast<const char*>(&len), 4);
+            out.write(reinterpret_cast<const char*>(bytes.data()), len);
+            rows++;
+        });
+        if (!out.flush()) return nullopt;
+        return rows;
+    }
+
+} // namespace ChronoDB
@@ -0,0 +1,296 @@
+// catalog.cpp
+#include "catalog.h"
+#include "paged_file.h"
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+#include <filesystem>
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace ChronoDB {
+
+    static string upper(string s) {
+        transform(s.begin(), s.end(), s.begin(), ::toupper);
+        return s;
+    }
+
+    static string trim(const string& s) {
+        size_t a = 0;
+        while (a < s.size() && isspace((unsigned char)s[a])) a++;
+        size_t b = s.size();
+        while (b > a && isspace((unsigned char)s[b - 1])) b--;
+        return s.substr(a, b - a);
+    }
+
+    // ---------- TableInfo ----------
+    optional<size_t> TableInfo::indexOf(const string& columnName) const {
+        auto it = columnIndex.find(upper(columnName));
+        if (it == columnIndex.end()) return nullopt;
+        return it->second;
+    }
+
+    bool TableInfo::matches(const Record& rec) const {
+        if (columns.empty()) return true; // legacy table without a schema: accept any
+        if (rec.fields.size() != columns.size()) return false;
+        for (size_t i = 0; i < columns.size(); ++i) {
+            if (rec.fields[i].index() != typeTags[i]) return false;
+        }
+        return true;
+    }
+
+    // ---------- Catalog ----------
+    // Catalog file layout (little endian):
+    //   magic u32 | version u32 | table count u32, then per table:
+    //   name | structure u8 | record format u8 | page size u32 | rowCount u64 | pageCount u32 |
+    //   column count u16 | (name | type)*
+    // where every string is a u16 length followed by its bytes. Version 1 had no
+    // record format byte (every table TAGGED), versions before 3 no page size (8 KB).
+    static constexpr uint32_t CATALOG_MAGIC = 0x54414343; // "CCAT"
+    static constexpr uint32_t CATALOG_VERSION = 3;
+
+    template <typename T>
+    static void put(vector<uint8_t>& out, T value) {
+        size_t pos = out.size();
+        out.resize(pos + sizeof(T));
+        memcpy(out.data() + pos, &value, sizeof(T));
+    }
+
+    static void putString(vector<uint8_t>& out, const string& s) {
+        put<uint16_t>(out, static_cast<uint16_t>(s.size()));
+        out.insert(out.end(), s.begin(), s.end());
+    }
+
+    // Bounds-checked cursor over the file contents
+    struct CatalogReader {
+        const vector<uint8_t>& in;
+        size_t pos = 0;
+
+        template <typename T>
+        bool get(T& value) {
+            if (pos + sizeof(T) > in.size()) return false;
+            memcpy(&value, in.data() + pos, sizeof(T));
+            pos += sizeof(T);
+            return true;
+        }
+
+        bool getString(string& s) {
+            uint16_t len = 0;
+            if (!get(len) || pos + len > in.size()) return false;
+            s.assign(reinterpret_cast<const char*>(in.data() + pos), len);
+            pos += len;
+            return true;
+        }
+    };
+
+    bool Catalog::load(const string& storageDir) {
+        directory = storageDir;
+        tables.clear();
+        dirty = false;
+        if (fs::exists(catalogPath())) {
+            if (readCatalogFile()) return true;
+            tables.clear();
+            return false;
+        }
+        importMetaFiles();
+        return tables.empty() || save();
+    }
+
+    const TableInfo* Catalog::find(const string& tableName) const {
+        auto it = tables.find(tableName);
+        return it == tables.end() ? nullptr : &it->second;
+    }
+
+    const TableInfo* Catalog::create(const string& tableName, const vector<Column>& columns, StructureType structure,
+                                     bool compactRows, uint32_t pageSize) {
+        if (tables.count(tableName) || !isValidPageSize(pageSize)) return nullptr;
+        TableInfo info;
+        info.name = tableName;
+        info.columns = columns;
+        info.structure = structure;
+        info.pageSize = pageSize;
+        resolve(info);
+        // the row layout is fixed for the table's lifetime
+        info.format = RecordCodec::formatFor(info.typeTags, compactRows);
+        info.codec = RecordCodec(info.format, info.typeTags);
+        TableInfo& stored = tables[tableName] = move(info);
+        if (!save()) {
+            tables.erase(tableName);
+            return nullptr;
+        }
+        return &stored;
+    }
+
+    vector<string> Catalog::tableNames() const {
+        vector<string> names;
+        names.reserve(tables.size());
+        for (const auto& entry : tables) names.push_back(entry.first);
+        sort(names.begin(), names.end());
+        return names;
+    }
+
+    void Catalog::setRowCount(const string& tableName, uint64_t rows) {
+        auto it = tables.find(tableName);
+        if (it == tables.end() || it->second.stats.rowCount == rows) return;
+        it->second.stats.rowCount = rows;
+        dirty = true;
+    }
+
+    void Catalog::setPageCount(const string& tableName, uint32_t pages) {
+        auto it = tables.find(tableName);
+        if (it == tables.end() || it->second.stats.pageCount == pages) return;
+        it->second.stats.pageCount = pages;
+        dirty = true;
+    }
+
+    bool Catalog::saveIfDirty() {
+        return !dirty || save();
+    }
+
+    StructureType Catalog::parseStructure(const string& name) {
+        if (name == "AVL") return StructureType::AVL;
+        if (name == "BST") return StructureType::BST;
+        if (name == "HASH") return StructureType::HASH;
+        if (name == "BTREE") return StructureType::BTREE;
+        if (name == "COLUMNAR") return StructureType::COLUMNAR;
+        return StructureType::HEAP;
+    }
+
+    string Catalog::structureName(StructureType type) {
+        switch (type) {
+            case StructureType::AVL: return "AVL";
+            case StructureType::BST: return "BST";
+            case StructureType::HASH: return "HASH";
+            case StructureType::BTREE: return "BTREE";
+            case StructureType::COLUMNAR: return "COLUMNAR";
+            case StructureType::HEAP:
+            default: return "HEAP";
+        }
+    }
+
+    uint8_t Catalog::typeTag(const string& typeName) {
+        string t = upper(typeName);
+        if (t == "INT") return TYPE_TAG_INT;
+        if (t == "FLOAT") return TYPE_TAG_FLOAT;
+        if (t == "STRING") return TYPE_TAG_STRING;
+        return TYPE_TAG_UNKNOWN;
+    }
+
+    // Derived lookups, rebuilt whenever the columns or the format change
+    void Catalog::resolve(TableInfo& info) {
+        info.typeTags.clear();
+        info.columnIndex.clear();
+        for (size_t i = 0; i < info.columns.size(); ++i) {
+            info.typeTags.push_back(typeTag(info.columns[i].type));
+            info.columnIndex.emplace(upper(info.columns[i].name), i);
+        }
+        info.codec = RecordCodec(info.format, info.typeTags);
+    }
+
+    string Catalog::catalogPath() const {
+        return directory + "/chronodb.catalog";
+    }
+
+    // The whole catalog is rewritten through replaceFile, so a crash or power loss
+    // leaves either the old or the new version
+    bool Catalog::save() {
+        vector<uint8_t> out;
+        put<uint32_t>(out, CATALOG_MAGIC);
+        put<uint32_t>(out, CATALOG_VERSION);
+        put<uint32_t>(out, static_cast<uint32_t>(tables.size()));
+        for (const auto& entry : tables) {
+            const TableInfo& info = entry.second;
+            putString(out, info.name);
+            put<uint8_t>(out, static_cast<uint8_t>(info.structure));
+            put<uint8_t>(out, static_cast<uint8_t>(info.format));
+            put<uint32_t>(out, info.pageSize);
+            put<uint64_t>(out, info.stats.rowCount);
+            put<uint32_t>(out, info.stats.pageCount);
+            put<uint16_t>(out, static_cast<uint16_t>(info.columns.size()));
+            for (const Column& col : info.columns) {
+                putString(out, col.name);
+                putString(out, col.type);
+            }
+        }
+
+        if (!replaceFile(catalogPath(), out)) return false;
+        dirty = false;
+        return true;
+    }
+
+    bool Catalog::readCatalogFile() {
+        ifstream f(catalogPath(), ios::binary | ios::ate);
+        if (!f) return false;
+        vector<uint8_t> in(static_cast<size_t>(f.tellg()));
+        f.seekg(0);
+        if (!f.read(reinterpret_cast<char*>(in.data()), static_cast<streamsize>(in.size()))) return false;
+
+        CatalogReader r{in};
+        uint32_t magic = 0, version = 0, count = 0;
+        if (!r.get(magic) || !r.get(version) || !r.get(count)) return false;
+        if (magic != CATALOG_MAGIC || version < 1 || version > CATALOG_VERSION) return false;
+        for (uint32_t i = 0; i < count; ++i) {
+            TableInfo info;
+            uint8_t structure = 0, format = 0;
+            uint16_t columnCount = 0;
+            if (!r.getString(info.name) || !r.get(structure) || (version >= 2 && !r.get(format)) ||
+                (version >= 3 && !r.get(info.pageSize)) || !r.get(info.stats.rowCount) ||
+                !r.get(info.stats.pageCount) || !r.get(columnCount))
+                return false;
+            if (structure > static_cast<uint8_t>(StructureType::COLUMNAR)) return false;
+            if (format > static_cast<uint8_t>(RecordFormat::COMPACT)) return false;
+            if (!isValidPageSize(info.pageSize)) return false;
+            info.structure = static_cast<StructureType>(structure);
+            info.format = static_cast<RecordFormat>(format);
+            info.columns.resize(columnCount);
+            for (Column& col : info.columns) {
+                if (!r.getString(col.name) || !r.getString(col.type)) return false;
+            }
+            resolve(info);
+            tables[info.name] = move(info);
+        }
+        return true;
+    }
+
+    // One-time migration of a data directory written before the catalog file
+    void Catalog::importMetaFiles() {
+        if (!fs::exists(directory)) return;
+        for (const auto& entry : fs::directory_iterator(directory)) {
+            if (entry.path().extension() != ".meta") continue;
+            optional<TableInfo> info = readMetaFile(entry.path().string());
+            if (!info.has_value()) continue;
+            info->name = entry.path().stem().string();
+            resolve(*info);
+            tables[info->name] = move(*info);
+        }
+    }
+
+    // --- Legacy meta files ---
+    // meta format: columns=col1:TYPE,col2:TYPE,col3:TYPE
+    //              structure=HEAP|AVL|BST|HASH|BTREE (missing in older files: HEAP)
+    optional<TableInfo> Catalog::readMetaFile(const string& path) const {
+        ifstream m(path);
+        if (!m) return nullopt;
+
+        TableInfo info;
+        string line;
+        while (getline(m, line)) {
+            if (line.rfind("structure=", 0) == 0) {
+                info.structure = parseStructure(trim(line.substr(strlen("structure="))));
+            } else if (line.rfind("columns=", 0) == 0) {
+                // split by ',' into name:TYPE tokens
+                stringstream ss(line.substr(strlen("columns=")));
+                string token;
+                while (getline(ss, token, ',')) {
+                    size_t pos = token.find(':');
+                    if (pos == string::npos) continue;
+                    info.columns.push_back({trim(token.substr(0, pos)), trim(token.substr(pos + 1))});
+                }
+            }
+        }
+        return info;
+    }
+
+} // namespace ChronoDB
@@ -0,0 +1,91 @@
+#ifndef CHRONODB_CATALOG_H
+#define CHRONODB_CATALOG_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include "../utils/types.h"
+#include "page.h"
+#include "record_codec.h"
+using namespace std;
+
+namespace ChronoDB {
+
+    // Column description
+    struct Column {
+        string name;   // column name (e.g., id, name)
+        string type;   // INT, FLOAT, STRING
+    };
+
+    // How a table keeps its rows
+    enum class StructureType { HEAP, AVL, BST, HASH, BTREE, COLUMNAR };
+
+    // Size of a table as last observed (full scans, VACUUM, checkpoints)
+    struct TableStats {
+        uint64_t rowCount = 0;
+        uint32_t pageCount = 0;
+    };
+
+    // Everything a statement needs to know about a table, resolved once
+    struct TableInfo {
+        string name;
+        vector<Column> columns;
+        StructureType structure = StructureType::HEAP;
+        RecordFormat format = RecordFormat::TAGGED;
+        uint32_t pageSize = DEFAULT_PAGE_SIZE;      // of every paged file of the table
+        TableStats stats;
+        vector<uint8_t> typeTags;                   // TYPE_TAG_* of each column
+        unordered_map<string, size_t> columnIndex;  // upper-cased column name -> position
+        RecordCodec codec;                          // encodes rows in `format`
+
+        // Position of a column (name matched case-insensitively)
+        optional<size_t> indexOf(const string& columnName) const;
+        // One value per column, each of its column's type (a table without columns accepts any)
+        bool matches(const Record& rec) const;
+    };
+
+    // Schemas, structure types and statistics of every table, kept in one binary
+    // file (chronodb.catalog) that is read once when the engine starts. After that
+    // a lookup is a hash probe. DDL rewrites the file at once; statistics only
+    // mark it dirty and are written with the next checkpoint.
+    class Catalog {
+    public:
+        // Reads the catalog file; a data directory without one is imported from
+        // its per-table .meta files (the format before the catalog file).
+        // False if the catalog file is unreadable.
+        bool load(const string& storageDir);
+
+        const TableInfo* find(const string& tableName) const;
+        // Adds the table and rewrites the catalog file; nullptr if it exists already
+        // or pageSize is not a valid page size. compactRows asks for the COMPACT row format.
+        const TableInfo* create(const string& tableName, const vector<Column>& columns, StructureType structure,
+                                bool compactRows = false, uint32_t pageSize = DEFAULT_PAGE_SIZE);
+        vector<string> tableNames() const;
+
+        void setRowCount(const string& tableName, uint64_t rows);
+        void setPageCount(const string& tableName, uint32_t pages);
+        // Writes the catalog file if statistics changed since it was last written
+        bool saveIfDirty();
+
+        static StructureType parseStructure(const string& name);
+        static string structureName(StructureType type);
+        static uint8_t typeTag(const string& typeName);
+
+    private:
+        string directory;
+        unordered_map<string, TableInfo> tables;
+        bool dirty = false;
+
+        string catalogPath() const;
+        bool save();
+        bool readCatalogFile();
+        void importMetaFiles();
+        optional<TableInfo> readMetaFile(const string& path) const;
+        static void resolve(TableInfo& info);
+    };
+
+} // namespace ChronoDB
+
+#endif // CHRONODB_CATALOG_H
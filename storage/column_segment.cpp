@@ -0,0 +1,224 @@
+// column_segment.cpp
+#include "column_segment.h"
+#include "record_codec.h"
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+using namespace std;
+
+namespace ChronoDB {
+
+    // ---------- PLAIN values ----------
+    static void putPlain(uint8_t typeTag, const RecordValue& v, vector<uint8_t>& out) {
+        if (typeTag == TYPE_TAG_STRING) {
+            const string& s = get<string>(v);
+            RecordCodec::putVarint(static_cast<uint32_t>(s.size()), out);
+            out.insert(out.end(), s.begin(), s.end());
+            return;
+        }
+        uint8_t raw[4];
+        if (typeTag == TYPE_TAG_INT) {
+            int32_t x = get<int>(v);
+            memcpy(raw, &x, 4);
+        } else {
+            float f = get<float>(v);
+            memcpy(raw, &f, 4);
+        }
+        out.insert(out.end(), raw, raw + 4);
+    }
+
+    // Bytes consumed, 0 if the value runs past end
+    static size_t readPlain(uint8_t typeTag, const uint8_t* in, const uint8_t* end, RecordValue& v) {
+        if (typeTag == TYPE_TAG_STRING) {
+            uint32_t len = 0;
+            size_t n = RecordCodec::readVarint(in, end, len);
+            if (!n || static_cast<size_t>(end - in) - n < len) return 0;
+            v = string(reinterpret_cast<const char*>(in + n), len);
+            return n + len;
+        }
+        if (end - in < 4) return 0;
+        if (typeTag == TYPE_TAG_INT) {
+            int32_t x;
+            memcpy(&x, in, 4);
+            v = x;
+        } else {
+            float f;
+            memcpy(&f, in, 4);
+            v = f;
+        }
+        return 4;
+    }
+
+    // ---------- Encoders (each appends the body after the header) ----------
+    static void encodePlain(uint8_t typeTag, const RecordValue* values, size_t count, vector<uint8_t>& out) {
+        for (size_t i = 0; i < count; ++i) putPlain(typeTag, values[i], out);
+    }
+
+    static void encodeRle(uint8_t typeTag, const RecordValue* values, size_t count, vector<uint8_t>& out) {
+        for (size_t i = 0; i < count;) {
+            size_t run = 1;
+            while (i + run < count && values[i + run] == values[i]) run++;
+            RecordCodec::putVarint(static_cast<uint32_t>(run), out);
+            putPlain(typeTag, values[i], out);
+            i += run;
+        }
+    }
+
+    // False if the column has too many distinct values for 2-byte codes
+    static bool encodeDictionary(uint8_t typeTag, const RecordValue* values, size_t count, vector<uint8_t>& out) {
+        unordered_map<RecordValue, uint32_t> codes;
+        vector<const RecordValue*> entries;
+        vector<uint32_t> rowCodes(count);
+        for (size_t i = 0; i < count; ++i) {
+            auto it = codes.emplace(values[i], static_cast<uint32_t>(entries.size())).first;
+            if (it->second == entries.size()) entries.push_back(&values[i]);
+            if (entries.size() > 65536) return false;
+            rowCodes[i] = it->second;
+        }
+        RecordCodec::putVarint(static_cast<uint32_t>(entries.size()), out);
+        for (const RecordValue* v : entries) putPlain(typeTag, *v, out);
+        bool wide = entries.size() > 256;
+        for (uint32_t code : rowCodes) {
+            out.push_back(static_cast<uint8_t>(code));
+            if (wide) out.push_back(static_cast<uint8_t>(code >> 8));
+        }
+        return true;
+    }
+
+    static void encodeFrameOfReference(const RecordValue* values, size_t count, vector<uint8_t>& out) {
+        int32_t lo = INT32_MAX, hi = INT32_MIN;
+        for (size_t i = 0; i < count; ++i) {
+            lo = min(lo, get<int>(values[i]));
+            hi = max(hi, get<int>(values[i]));
+        }
+        if (count == 0) lo = hi = 0;
+        uint32_t range = static_cast<uint32_t>(hi) - static_cast<uint32_t>(lo);
+        uint8_t bits = 0;
+        while (bits < 32 && (range >> bits) != 0) bits++;
+
+        size_t pos = out.size();
+        out.resize(pos + 5 + (count * bits + 7) / 8, 0);
+        memcpy(out.data() + pos, &lo, 4);
+        out[pos + 4] = bits;
+        uint8_t* packed = out.data() + pos + 5;
+        size_t packedBytes = out.size() - pos - 5;
+        for (size_t i = 0; i < count && bits > 0; ++i) {
+            size_t bit = i * bits;
+            uint64_t delta = static_cast<uint64_t>(static_cast<uint32_t>(get<int>(values[i])) - static_cast<uint32_t>(lo));
+            delta <<= bit & 7;
+            for (size_t k = 0; k < 5 && (bit >> 3) + k < packedBytes; ++k)
+                packed[(bit >> 3) + k] |= static_cast<uint8_t>(delta >> (8 * k));
+        }
+    }
+
+    // ---------- ColumnSegment ----------
+    void ColumnSegment::encode(uint8_t typeTag, const RecordValue* values, size_t count, vector<uint8_t>& out) {
+        auto start = [&](vector<uint8_t>& buf, SegmentEncoding encoding) {
+            uint32_t rows = static_cast<uint32_t>(count);
+            buf.assign(HEADER_BYTES, 0);
+            buf[0] = static_cast<uint8_t>(encoding);
+            memcpy(buf.data() + 1, &rows, 4);
+        };
+        start(out, SegmentEncoding::PLAIN);
+        encodePlain(typeTag, values, count, out);
+
+        vector<uint8_t> candidate;
+        auto keepIfSmaller = [&]() {
+            if (candidate.size() < out.size()) out.swap(candidate);
+        };
+        start(candidate, SegmentEncoding::RLE);
+        encodeRle(typeTag, values, count, candidate);
+        keepIfSmaller();
+        start(candidate, SegmentEncoding::DICTIONARY);
+        if (encodeDictionary(typeTag, values, count, candidate)) keepIfSmaller();
+        if (typeTag == TYPE_TAG_INT) {
+            start(candidate, SegmentEncoding::FRAME_OF_REFERENCE);
+            encodeFrameOfReference(values, count, candidate);
+            keepIfSmaller();
+        }
+    }
+
+    bool ColumnSegment::decode(uint8_t typeTag, const uint8_t* in, size_t size, vector<RecordValue>& out) {
+        if (size < HEADER_BYTES) return false;
+        uint8_t encoding = in[0];
+        uint32_t count = 0;
+        memcpy(&count, in + 1, 4);
+        const uint8_t* end = in + size;
+        in += HEADER_BYTES;
+        size_t target = out.size() + count;
+        out.reserve(target);
+
+        RecordValue v;
+        switch (static_cast<SegmentEncoding>(encoding)) {
+            case SegmentEncoding::PLAIN:
+                while (out.size() < target) {
+                    size_t n = readPlain(typeTag, in, end, v);
+                    if (!n) return false;
+                    in += n;
+                    out.push_back(move(v));
+                }
+                break;
+            case SegmentEncoding::RLE:
+                while (out.size() < target) {
+                    uint32_t run = 0;
+                    size_t n = RecordCodec::readVarint(in, end, run);
+                    if (!n || run == 0 || run > target - out.size()) return false;
+                    in += n;
+                    n = readPlain(typeTag, in, end, v);
+                    if (!n) return false;
+                    in += n;
+                    out.insert(out.end(), run, v);
+                }
+                break;
+            case SegmentEncoding::DICTIONARY: {
+                uint32_t entries = 0;
+                size_t n = RecordCodec::readVarint(in, end, entries);
+                if (!n || entries > 65536) return false;
+                in += n;
+                vector<RecordValue> dictionary(entries);
+                for (RecordValue& entry : dictionary) {
+                    n = readPlain(typeTag, in, end, entry);
+                    if (!n) return false;
+                    in += n;
+                }
+                size_t width = entries > 256 ? 2 : 1;
+                if (static_cast<size_t>(end - in) < count * width) return false;
+                for (uint32_t i = 0; i < count; ++i, in += width) {
+                    uint32_t code = width == 2 ? (in[0] | (in[1] << 8)) : in[0];
+                    if (code >= entries) return false;
+                    out.push_back(dictionary[code]);
+                }
+                break;
+            }
+            case SegmentEncoding::FRAME_OF_REFERENCE: {
+                if (typeTag != TYPE_TAG_INT || end - in < 5) return false;
+                int32_t lo;
+                memcpy(&lo, in, 4);
+                uint8_t bits = in[4];
+                in += 5;
+                size_t packedBytes = (static_cast<size_t>(count) * bits + 7) / 8;
+                if (bits > 32 || static_cast<size_t>(end - in) < packedBytes) return false;
+                uint64_t mask = (uint64_t(1) << bits) - 1;
+                for (uint32_t i = 0; i < count; ++i) {
+                    size_t bit = static_cast<size_t>(i) * bits;
+                    uint64_t window = 0;
+                    for (size_t k = 0; k < 5 && (bit >> 3) + k < packedBytes; ++k)
+                        window |= static_cast<uint64_t>(in[(bit >> 3) + k]) << (8 * k);
+                    uint32_t delta = static_cast<uint32_t>((window >> (bit & 7)) & mask);
+                    out.push_back(static_cast<int32_t>(static_cast<uint32_t>(lo) + delta));
+                }
+                in += packedBytes;
+                break;
+            }
+            default:
+                return false;
+        }
+        return in == end;
+    }
+
+    bool ColumnSegment::fits(const RecordValue& value, uint32_t pageSize) {
+        if (!holds_alternative<string>(value)) return true;
+        return HEADER_BYTES + 5 + get<string>(value).size() <= maxBytes(pageSize);
+    }
+
+} // namespace ChronoDB
@@ -0,0 +1,43 @@
+#ifndef CHRONODB_COLUMN_SEGMENT_H
+#define CHRONODB_COLUMN_SEGMENT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "../utils/types.h"
+#include "page.h"
+using namespace std;
+
+namespace ChronoDB {
+
+    // How the values of one column segment are stored
+    enum class SegmentEncoding : uint8_t {
+        PLAIN = 0,              // int32 | float | (varint length + bytes), one per row
+        RLE = 1,                // (varint run length + one PLAIN value) per run of equal values
+        DICTIONARY = 2,         // varint entry count + PLAIN entries, then a 1- or 2-byte code per row
+        FRAME_OF_REFERENCE = 3  // INT only: minimum int32 + bit width u8 + (value - minimum) bit-packed
+    };
+
+    // One column's values for a run of consecutive rows, stored as a single record
+    // on a page of the column's file (storage/columnar_table.cpp). Layout:
+    //   encoding u8 | row count u32 | encoded values
+    // encode() tries every encoding that applies to the column type and keeps the
+    // smallest, so sorted ids, low-cardinality strings and repeated values all
+    // shrink without any per-table setting.
+    class ColumnSegment {
+    public:
+        static constexpr size_t HEADER_BYTES = 5;
+        // Largest segment that fits on a page of pageSize bytes
+        static size_t maxBytes(uint32_t pageSize) { return pageSize - PAGE_HEADER_RESERVED - SLOT_ENTRY_BYTES; }
+
+        // values must all be of the column type typeTag (TYPE_TAG_*)
+        static void encode(uint8_t typeTag, const RecordValue* values, size_t count, vector<uint8_t>& out);
+        // Appends the segment's values to out; false if the bytes are damaged
+        static bool decode(uint8_t typeTag, const uint8_t* in, size_t size, vector<RecordValue>& out);
+        // A single value too large for a segment cannot be stored in a COLUMNAR table
+        static bool fits(const RecordValue& value, uint32_t pageSize);
+    };
+
+} // namespace ChronoDB
+
+#endif // CHRONODB_COLUMN_SEGMENT_H
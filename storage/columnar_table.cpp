@@ -0,0 +1,367 @@
+// columnar_table.cpp
+#include "storage.h"
+#include <cstring>
+#include <algorithm>
+using namespace std;
+
+namespace ChronoDB {
+
+    // ---------- COLUMNAR tables ----------
+    // Each column has its own paged file, <table>.c<i>. A page holds one segment:
+    // that column's values for a run of consecutive rows, encoded on its own
+    // (storage/column_segment.h). Columns are cut into segments independently, so
+    // a column of small ints covers far more rows per page than a string column.
+    //
+    // New rows collect in an in-memory tail and are sealed into segments once
+    // enough of them have arrived to fill pages of the table's page size
+    // (COLUMNAR_SEAL_ROWS for 8 KB pages). Segments are never rewritten: a
+    // delete only marks the row, and an update deletes the old row and appends
+    // the new one. Like the other in-memory structures, the tail, the segment
+    // directory and the deleted rows go into <table>.snap at checkpoints, and
+    // changes made after the last checkpoint are lost in a crash (segment pages
+    // past what the snapshot lists are cut off when the table is opened). The
+    // snapshot is written when the table is created, so one that is missing or
+    // damaged later is reported and the column files are left alone.
+
+    static constexpr size_t COLUMNAR_SEAL_ROWS = 4096;
+
+    static size_t sealRows(uint32_t pageSize) {
+        return COLUMNAR_SEAL_ROWS * pageSize / DEFAULT_PAGE_SIZE;
+    }
+
+    // Empty table: no segments, column files cut to nothing
+    void StorageEngine::resetColumnarTable(const string& tableName) {
+        const TableInfo* info = catalog.find(tableName);
+        ColumnarTable& table = columnarTables[tableName] = ColumnarTable();
+        if (!info) return;
+        table.segmentStarts.resize(info->columns.size());
+        table.decoded.resize(info->columns.size());
+        for (size_t c = 0; c < info->columns.size(); ++c) {
+            string key = columnFileKey(tableName, c);
+            bufferPool.discardPages(key, 0);
+            if (PagedFile* file = tableFile(key, true)) file->truncate(0);
+        }
+    }
+
+    // True when no column file of the table holds a page: a new or emptied table
+    bool StorageEngine::columnFilesEmpty(const string& tableName) {
+        const TableInfo* info = catalog.find(tableName);
+        if (!info) return true;
+        for (size_t c = 0; c < info->columns.size(); ++c)
+            if (pageCount(columnFileKey(tableName, c)) > 0) return false;
+        return true;
+    }
+
+    bool StorageEngine::insertColumnarRecord(const string& tableName, const Record& rec) {
+        const TableInfo* info = catalog.find(tableName);
+        if (!info || info->columns.empty() || !info->matches(rec)) return false;
+        if (!holds_alternative<int>(rec.fields[0])) return false;
+        for (const RecordValue& v : rec.fields)
+            if (!ColumnSegment::fits(v, info->pageSize)) return false;
+
+        ColumnarTable& table = columnarTables[tableName];
+        int id = get<int>(rec.fields[0]);
+        // upsert, like HEAP inserts
+        auto it = table.rowOfId.find(id);
+        optional<uint32_t> replaced;
+        if (it != table.rowOfId.end()) {
+            replaced = it->second;
+            table.deleted[it->second] = true;
+        }
+        table.rowOfId[id] = table.rowCount();
+        table.tail.push_back(rec);
+        table.deleted.push_back(false);
+        dirtySnapshots.insert(tableName);
+
+        if (table.tail.size() < sealRows(info->pageSize) || sealColumnarTail(tableName, table)) return true;
+        // the tail could not be sealed: take the row back out
+        table.tail.pop_back();
+        table.deleted.pop_back();
+        if (replaced.has_value()) {
+            table.deleted[*replaced] = false;
+            table.rowOfId[id] = *replaced;
+        } else {
+            table.rowOfId.erase(id);
+        }
+        return false;
+    }
+
+    bool StorageEngine::updateColumnarRecord(const string& tableName, int id, const Record& newRecord) {
+        ColumnarTable& table = columnarTables[tableName];
+        auto it = table.rowOfId.find(id);
+        if (it == table.rowOfId.end()) return false;
+        if (newRecord.fields.empty() || !holds_alternative<int>(newRecord.fields[0])) return false;
+        int newId = get<int>(newRecord.fields[0]);
+        if (newId != id && table.rowOfId.count(newId)) return false;
+        for (const RecordValue& v : newRecord.fields)
+            if (!ColumnSegment::fits(v, pageSizeOf(tableName))) return false;
+
+        uint32_t row = it->second;
+        table.deleted[row] = true;
+        table.rowOfId.erase(it);
+        if (insertColumnarRecord(tableName, newRecord)) return true;
+        table.deleted[row] = false;
+        table.rowOfId[id] = row;
+        return false;
+    }
+
+    bool StorageEngine::deleteColumnarRecord(const string& tableName, int id) {
+        ColumnarTable& table = columnarTables[tableName];
+        auto it = table.rowOfId.find(id);
+        if (it == table.rowOfId.end()) return false;
+        table.deleted[it->second] = true;
+        table.rowOfId.erase(it);
+        dirtySnapshots.insert(tableName);
+        return true;
+    }
+
+    // One segment per column is decoded to put the row together
+    optional<Record> StorageEngine::findColumnarRecord(const string& tableName, int id) {
+        ColumnarTable& table = columnarTables[tableName];
+        auto it = table.rowOfId.find(id);
+        if (it == table.rowOfId.end()) return nullopt;
+        Record rec;
+        for (size_t c = 0; c < table.segmentStarts.size(); ++c) {
+            const RecordValue* v = columnValue(tableName, table, c, it->second);
+            if (!v) return nullopt;
+            rec.fields.push_back(*v);
+        }
+        return rec;
+    }
+
+    // Cuts each column of the tail into as many page-sized segments as it needs
+    // and appends them to the column's file. The pages are written straight to the
+    // file, not through the buffer pool: they are new and never change. Every
+    // column is encoded before anything is written, and if a page cannot be
+    // written all column files are cut back, so the table is left as it was.
+    bool StorageEngine::sealColumnarTail(const string& tableName, ColumnarTable& table) {
+        const TableInfo* info = catalog.find(tableName);
+        if (!info) return false;
+        if (table.tail.empty()) return true;
+        size_t rows = table.tail.size();
+        size_t columns = table.segmentStarts.size();
+        vector<vector<vector<uint8_t>>> segments(columns);
+        vector<vector<uint32_t>> starts(columns);
+        vector<RecordValue> values(rows);
+        size_t maxBytes = ColumnSegment::maxBytes(info->pageSize);
+        for (size_t c = 0; c < columns; ++c) {
+            for (size_t r = 0; r < rows; ++r) values[r] = table.tail[r].fields[c];
+            for (size_t start = 0; start < rows;) {
+                // shrink the run until its encoding fits on a page
+                size_t count = rows - start;
+                vector<uint8_t> bytes;
+                for (;;) {
+                    ColumnSegment::encode(info->typeTags[c], values.data() + start, count, bytes);
+                    if (bytes.size() <= maxBytes || count == 1) break;
+                    count = max<size_t>(1, min(count - 1, count * maxBytes / bytes.size()));
+                }
+                segments[c].push_back(move(bytes));
+                starts[c].push_back(table.sealedRows + static_cast<uint32_t>(start));
+                start += count;
+            }
+        }
+
+        // segment i of a column is page i of its file
+        vector<PagedFile*> files(columns);
+        auto cutBack = [&]() {
+            bool ok = true;
+            for (size_t c = 0; c < columns; ++c) {
+                if (!files[c] || files[c]->pageCount() == table.segmentStarts[c].size()) continue;
+                uint32_t keep = static_cast<uint32_t>(table.segmentStarts[c].size());
+                bufferPool.discardPages(columnFileKey(tableName, c), keep);
+                ok = files[c]->truncate(keep) && ok;
+            }
+            return ok;
+        };
+        for (size_t c = 0; c < columns; ++c) {
+            files[c] = tableFile(columnFileKey(tableName, c), true);
+            if (!files[c]) return false;
+        }
+        if (!cutBack()) return false;
+
+        PageBuffer buffer(info->pageSize);
+        for (size_t c = 0; c < columns; ++c) {
+            for (const vector<uint8_t>& bytes : segments[c]) {
+                Page page(info->pageSize);
+                page.setPageID(files[c]->pageCount());
+                page.insertRawRecord(bytes);
+                page.serializeToBuffer(buffer.data());
+                if (!files[c]->appendPage(buffer.data())) {
+                    cutBack();
+                    return false;
+                }
+            }
+        }
+        for (size_t c = 0; c < columns; ++c)
+            table.segmentStarts[c].insert(table.segmentStarts[c].end(), starts[c].begin(), starts[c].end());
+        table.sealedRows += static_cast<uint32_t>(rows);
+        table.tail.clear();
+        return true;
+    }
+
+    bool StorageEngine::readColumnSegment(const string& tableName, size_t column, uint32_t segment,
+                                          vector<RecordValue>& out) {
+        const TableInfo* info = catalog.find(tableName);
+        if (!info || column >= info->typeTags.size()) return false;
+        PageHandle p(bufferPool, columnFileKey(tableName, column), segment);
+        if (!p.valid() || p->slotCount() == 0 || !p->slot(0).holdsRecord()) return false;
+        SlotEntry e = p->slot(0);
+        return ColumnSegment::decode(info->typeTags[column], p->data.data() + e.recordOffset(), e.recordLength(), out);
+    }
+
+    // A row's value in one column. Sealed rows come from the column's decoded
+    // segment, which is decoded again only when the row lies in another one, so
+    // reading rows in order decodes each segment once. nullptr if it is unreadable.
+    const RecordValue* StorageEngine::columnValue(const string& tableName, ColumnarTable& table, size_t column,
+                                                  uint32_t row) {
+        if (row >= table.sealedRows) return &table.tail[row - table.sealedRows].fields[column];
+        const vector<uint32_t>& starts = table.segmentStarts[column];
+        ColumnarTable::DecodedSegment& decoded = table.decoded[column];
+        uint32_t current = decoded.segment;
+        bool inCurrent = current != UINT32_MAX && row >= starts[current] &&
+                         (current + 1 == starts.size() || row < starts[current + 1]);
+        if (!inCurrent) {
+            current = static_cast<uint32_t>(upper_bound(starts.begin(), starts.end(), row) - starts.begin()) - 1;
+            decoded.values.clear();
+            decoded.segment = readColumnSegment(tableName, column, current, decoded.values) ? current : UINT32_MAX;
+            if (decoded.segment == UINT32_MAX) return nullptr;
+        }
+        size_t k = row - starts[current];
+        return k < decoded.values.size() ? &decoded.values[k] : nullptr;
+    }
+
+    // A batch covers the next batchRows row numbers. With a filter (or id bounds)
+    // only the tested column is decoded for the whole batch; the other columns are
+    // read just for the rows that pass, so their pages are only touched where a
+    // match is.
+    size_t StorageEngine::readColumnarBatch(TableCursor& cursor, const TableCursor::RowVisitor& emit) {
+        ColumnarTable& table = columnarTables[cursor.tableName];
+        uint32_t total = table.rowCount();
+        uint32_t first = cursor.row;
+        uint32_t last = first + static_cast<uint32_t>(min<size_t>(cursor.batchRows, total - first));
+        vector<uint32_t> matches;
+        RecordView view;
+        for (uint32_t row = first; row < last; ++row) {
+            if (table.deleted[row]) continue;
+            if (cursor.bounded) {
+                const RecordValue* id = columnValue(cursor.tableName, table, 0, row);
+                if (!id || get<int>(*id) < cursor.from || get<int>(*id) > cursor.to) continue;
+            }
+            if (cursor.filter) {
+                const RecordValue* v = columnValue(cursor.tableName, table, cursor.filterColumn, row);
+                if (!v) continue;
+                view.reset(cursor.filterColumn, *v);
+                if (!(*cursor.filter)(view)) continue;
+            }
+            matches.push_back(row);
+        }
+
+        Record rec;
+        size_t emitted = 0;
+        for (uint32_t row : matches) {
+            rec.fields.clear();
+            for (size_t c = 0; c < table.segmentStarts.size(); ++c) {
+                const RecordValue* v = columnValue(cursor.tableName, table, c, row);
+                if (!v) break;
+                rec.fields.push_back(*v);
+            }
+            if (rec.fields.size() != table.segmentStarts.size()) continue;
+            view.reset(rec);
+            emit(view);
+            emitted++;
+        }
+
+        cursor.row = last;
+        if (last >= total) cursor.exhausted = true;
+        return emitted;
+    }
+
+    // Snapshot section after the tail rows:
+    //   column count u16 | sealedRows u32 | per column: segment count u32 + first row u32 each
+    //   | deleted count u32 + row u32 each
+    void StorageEngine::appendColumnarState(const string& tableName, vector<uint8_t>& out) {
+        const ColumnarTable& table = columnarTables[tableName];
+        auto put32 = [&](uint32_t x) {
+            size_t pos = out.size();
+            out.resize(pos + 4);
+            memcpy(out.data() + pos, &x, 4);
+        };
+        uint16_t columns = static_cast<uint16_t>(table.segmentStarts.size());
+        out.push_back(static_cast<uint8_t>(columns));
+        out.push_back(static_cast<uint8_t>(columns >> 8));
+        put32(table.sealedRows);
+        for (const vector<uint32_t>& starts : table.segmentStarts) {
+            put32(static_cast<uint32_t>(starts.size()));
+            for (uint32_t s : starts) put32(s);
+        }
+        vector<uint32_t> deleted;
+        for (uint32_t row = 0; row < table.deleted.size(); ++row)
+            if (table.deleted[row]) deleted.push_back(row);
+        put32(static_cast<uint32_t>(deleted.size()));
+        for (uint32_t row : deleted) put32(row);
+    }
+
+    // Restores the table from its snapshot and rebuilds the id map from the id
+    // column alone. Segment pages written after the snapshot are dropped only
+    // once all of it has checked out.
+    bool StorageEngine::loadColumnarState(const string& tableName, vector<Record>& tail, const vector<uint8_t>& in,
+                                          size_t pos) {
+        const TableInfo* info = catalog.find(tableName);
+        if (!info) return false;
+        auto get32 = [&](uint32_t& x) {
+            if (pos + 4 > in.size()) return false;
+            memcpy(&x, in.data() + pos, 4);
+            pos += 4;
+            return true;
+        };
+        ColumnarTable table;
+        if (pos + 2 > in.size()) return false;
+        uint16_t columns = static_cast<uint16_t>(in[pos] | (in[pos + 1] << 8));
+        pos += 2;
+        if (columns != info->columns.size() || !get32(table.sealedRows)) return false;
+        table.segmentStarts.resize(columns);
+        table.decoded.resize(columns);
+        for (vector<uint32_t>& starts : table.segmentStarts) {
+            uint32_t count = 0;
+            if (!get32(count) || count > (in.size() - pos) / 4) return false;
+            starts.resize(count);
+            for (uint32_t& s : starts) get32(s);
+            // every sealed row is in exactly one segment of each column
+            if (starts.empty() != (table.sealedRows == 0)) return false;
+            if (count > 0 && (starts[0] != 0 || starts.back() >= table.sealedRows)) return false;
+            if (!is_sorted(starts.begin(), starts.end())) return false;
+        }
+        table.tail = move(tail);
+        table.deleted.assign(table.rowCount(), false);
+        uint32_t deleted = 0;
+        if (!get32(deleted)) return false;
+        for (uint32_t i = 0; i < deleted; ++i) {
+            uint32_t row = 0;
+            if (!get32(row) || row >= table.deleted.size()) return false;
+            table.deleted[row] = true;
+        }
+
+        for (size_t c = 0; c < columns; ++c) {
+            if (pageCount(columnFileKey(tableName, c)) < table.segmentStarts[c].size()) return false;
+        }
+        for (uint32_t row = 0; row < table.rowCount(); ++row) {
+            if (table.deleted[row]) continue;
+            const RecordValue* id = columnValue(tableName, table, 0, row);
+            if (!id || !holds_alternative<int>(*id)) return false;
+            table.rowOfId[get<int>(*id)] = row;
+        }
+
+        for (size_t c = 0; c < columns; ++c) {
+            string key = columnFileKey(tableName, c);
+            uint32_t segments = static_cast<uint32_t>(table.segmentStarts[c].size());
+            PagedFile* file = tableFile(key, true);
+            if (!file) return false;
+            if (file->pageCount() == segments) continue;
+            bufferPool.discardPages(key, segments);
+            file->truncate(segments);
+        }
+        columnarTables[tableName] = move(table);
+        return true;
+    }
+
+} // namespace ChronoDB
@@ -0,0 +1,89 @@
+// free_space_map.cpp
+#include "free_space_map.h"
+#include <fstream>
+#include <algorithm>
+using namespace std;
+
+namespace ChronoDB {
+
+    // ---------- FreeSpaceMap ----------
+    bool FreeSpaceMap::load(const string& path) {
+        ifstream in(path, ios::binary | ios::ate);
+        if (!in) return false;
+        streamoff size = in.tellg();
+        if (size < 0) return false;
+        vector<uint8_t> buckets(static_cast<size_t>(size));
+        in.seekg(0);
+        if (!buckets.empty() && !in.read(reinterpret_cast<char*>(buckets.data()), size)) return false;
+
+        tree.clear();
+        leaves = 0;
+        pages = 0;
+        resize(static_cast<uint32_t>(buckets.size()));
+        for (uint32_t i = 0; i < buckets.size(); ++i) setLeaf(i, buckets[i]);
+        dirty = false;
+        return true;
+    }
+
+    bool FreeSpaceMap::save(const string& path) {
+        ofstream out(path, ios::binary | ios::trunc);
+        if (!out) return false;
+        if (pages > 0) out.write(reinterpret_cast<const char*>(tree.data() + leaves), pages);
+        if (!out) return false;
+        dirty = false;
+        return true;
+    }
+
+    void FreeSpaceMap::resize(uint32_t pageCount) {
+        if (pageCount > leaves) {
+            // grow to the next power of two and rebuild the inner nodes
+            uint32_t newLeaves = max<uint32_t>(leaves, 64);
+            while (newLeaves < pageCount) newLeaves *= 2;
+            vector<uint8_t> grown(2 * static_cast<size_t>(newLeaves), 0);
+            for (uint32_t i = 0; i < pages; ++i) grown[newLeaves + i] = tree[leaves + i];
+            for (uint32_t i = newLeaves - 1; i >= 1; --i) grown[i] = max(grown[2 * i], grown[2 * i + 1]);
+            tree = move(grown);
+            leaves = newLeaves;
+        }
+        // pages past the end must never be found
+        for (uint32_t i = pageCount; i < pages; ++i) setLeaf(i, 0);
+        if (pageCount != pages) dirty = true;
+        pages = pageCount;
+    }
+
+    void FreeSpaceMap::update(uint32_t pageIndex, uint16_t freeBytes) {
+        if (pageIndex >= pages) resize(pageIndex + 1);
+        uint8_t bucket = static_cast<uint8_t>(min<uint32_t>(255, freeBytes / bucketBytes));
+        if (tree[leaves + pageIndex] == bucket) return;
+        setLeaf(pageIndex, bucket);
+        dirty = true;
+    }
+
+    uint32_t FreeSpaceMap::freeBytes(uint32_t pageIndex) const {
+        if (pageIndex >= pages) return 0;
+        return tree[leaves + pageIndex] * bucketBytes;
+    }
+
+    optional<uint32_t> FreeSpaceMap::findPage(uint32_t neededBytes) const {
+        if (pages == 0) return nullopt;
+        uint32_t bucket = (neededBytes + bucketBytes - 1) / bucketBytes;
+        if (bucket == 0) bucket = 1;
+        if (tree[1] < bucket) return nullopt;
+
+        // descend towards the leftmost leaf that is big enough
+        uint32_t node = 1;
+        while (node < leaves) node = tree[2 * node] >= bucket ? 2 * node : 2 * node + 1;
+        return node - leaves;
+    }
+
+    void FreeSpaceMap::setLeaf(uint32_t pageIndex, uint8_t bucket) {
+        uint32_t node = leaves + pageIndex;
+        tree[node] = bucket;
+        for (node /= 2; node >= 1; node /= 2) {
+            uint8_t m = max(tree[2 * node], tree[2 * node + 1]);
+            if (tree[node] == m) break;
+            tree[node] = m;
+        }
+    }
+
+} // namespace ChronoDB
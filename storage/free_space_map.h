@@ -0,0 +1,49 @@
+#ifndef CHRONODB_FREE_SPACE_MAP_H
+#define CHRONODB_FREE_SPACE_MAP_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include "page.h"
+using namespace std;
+
+namespace ChronoDB {
+
+    // Per-table summary of free space: one byte per page holding the page's free
+    // bytes in buckets of 1/256 of a page, 32 bytes for 8 KB pages (rounded down,
+    // so it never promises too much).
+    // The bytes are the leaves of an in-memory max tree, so finding a page with
+    // room and updating a page are O(log pages) and full pages are never visited.
+    // Persisted as the raw bucket bytes in <table>.fsm; it is only a hint, the
+    // insert path always checks the page itself.
+    class FreeSpaceMap {
+    public:
+        explicit FreeSpaceMap(uint32_t pageSize = DEFAULT_PAGE_SIZE) : bucketBytes(pageSize / 256) {}
+
+        bool load(const string& path);
+        bool save(const string& path);
+
+        uint32_t pageCount() const { return pages; }
+        void resize(uint32_t pageCount);
+        void update(uint32_t pageIndex, uint16_t freeBytes);
+        // Free bytes recorded for the page (lower bound)
+        uint32_t freeBytes(uint32_t pageIndex) const;
+        // Lowest page index with at least neededBytes free
+        optional<uint32_t> findPage(uint32_t neededBytes) const;
+
+        bool isDirty() const { return dirty; }
+
+    private:
+        uint32_t bucketBytes;
+        vector<uint8_t> tree;   // tree[1] is the root, leaves start at tree[leaves]
+        uint32_t leaves = 0;
+        uint32_t pages = 0;
+        bool dirty = false;
+
+        void setLeaf(uint32_t pageIndex, uint8_t bucket);
+    };
+
+} // namespace ChronoDB
+
+#endif // CHRONODB_FREE_SPACE_MAP_H
@@ -0,0 +1,238 @@
+// page.cpp
+#include "page.h"
+#include <cstring>
+#include <algorithm>
+#include <array>
+using namespace std;
+
+namespace ChronoDB {
+
+    // ---------- Page ----------
+    Page::Page(uint32_t pageSize) {
+        reset(pageSize);
+    }
+
+    void Page::reset(uint32_t pageSize) {
+        if (data.size() == pageSize) fill(data.begin(), data.end(), 0);
+        else data = PageBuffer(pageSize, 0);
+        setFreeSpaceOffset(PAGE_HEADER_RESERVED);
+        setDeadSlots(0);
+    }
+
+    void Page::setSlot(uint16_t slotID, const SlotEntry& entry) {
+        size_t pos = slotPosition(slotID);
+        data[pos] = entry.state;
+        store<uint16_t>(pos + 1, entry.length);
+        store<uint16_t>(pos + 3, entry.offset);
+    }
+
+    void Page::insertSlot(uint16_t pos, const SlotEntry& entry) {
+        // the entries before pos move down one place, the ones from pos on stay put
+        uint16_t n = slotCount();
+        uint8_t* directory = data.data() + data.size() - static_cast<size_t>(SLOT_ENTRY_BYTES) * n;
+        memmove(directory - SLOT_ENTRY_BYTES, directory, static_cast<size_t>(SLOT_ENTRY_BYTES) * pos);
+        setSlotCount(static_cast<uint16_t>(n + 1));
+        setSlot(pos, entry);
+    }
+
+    void Page::eraseSlot(uint16_t pos) {
+        uint16_t n = slotCount();
+        if (pos >= n) return;
+        if (slot(pos).state == SLOT_DEAD) setDeadSlots(static_cast<uint16_t>(deadSlots() - 1));
+        uint8_t* directory = data.data() + data.size() - static_cast<size_t>(SLOT_ENTRY_BYTES) * n;
+        memmove(directory + SLOT_ENTRY_BYTES, directory, static_cast<size_t>(SLOT_ENTRY_BYTES) * pos);
+        setSlotCount(static_cast<uint16_t>(n - 1));
+    }
+
+    uint16_t Page::deadSlots() const {
+        uint16_t stored = load<uint16_t>(PAGE_DEAD_SLOTS_OFFSET);
+        if (stored != 0) return static_cast<uint16_t>(stored - 1);
+        uint16_t dead = 0;
+        for (uint16_t i = 0; i < slotCount(); ++i)
+            if (data[slotPosition(i)] == SLOT_DEAD) dead++;
+        return dead;
+    }
+
+    uint16_t Page::freeSpace() const {
+        uint32_t slotDirBytes = static_cast<uint32_t>(slotCount()) * SLOT_ENTRY_BYTES;
+        if (usedDataBytes() + slotDirBytes >= size()) return 0;
+        return static_cast<uint16_t>(size() - usedDataBytes() - slotDirBytes);
+    }
+
+    optional<uint16_t> Page::insertRawRecord(const vector<uint8_t>& rec, uint8_t state) {
+        uint16_t need = static_cast<uint16_t>(rec.size());
+
+        // reuse a dead slot entry when there is one, else grow the slot directory
+        uint16_t n = slotCount();
+        uint16_t dead = deadSlots();
+        uint16_t slotID = n;
+        for (uint16_t i = 0; dead > 0 && i < n; ++i) {
+            if (data[slotPosition(i)] == SLOT_DEAD) { slotID = i; break; }
+        }
+        uint16_t slotOverhead = slotID < n ? 0 : SLOT_ENTRY_BYTES;
+        if (freeSpace() < need + slotOverhead) return nullopt;
+
+        uint16_t offset = freeSpaceOffset();
+        memcpy(data.data() + offset, rec.data(), need);
+        if (slotID < n) {
+            setSlot(slotID, SlotEntry(offset, need, state));
+            setDeadSlots(static_cast<uint16_t>(dead - 1));
+        } else {
+            insertSlot(n, SlotEntry(offset, need, state));
+        }
+        setFreeSpaceOffset(static_cast<uint16_t>(offset + need));
+        return slotID;
+    }
+
+    bool Page::deleteSlot(uint16_t slotID) {
+        if (slotID >= slotCount() || data[slotPosition(slotID)] == SLOT_DEAD) return false;
+        setDeadSlots(static_cast<uint16_t>(deadSlots() + 1));
+        setSlotState(slotID, SLOT_DEAD);
+        return true;
+    }
+
+    bool Page::readRawRecord(uint16_t slotID, vector<uint8_t>& out) const {
+        if (slotID >= slotCount()) return false;
+        SlotEntry s = slot(slotID);
+        if (!s.holdsRecord() || s.offset + s.length > size()) return false;
+        out.assign(data.begin() + s.recordOffset(), data.begin() + s.recordOffset() + s.recordLength());
+        return true;
+    }
+
+    bool Page::replaceRecord(uint16_t slotID, const vector<uint8_t>& rec) {
+        if (slotID >= slotCount()) return false;
+        SlotEntry s = slot(slotID);
+        if (s.state == SLOT_DEAD) return false;
+        uint16_t len = static_cast<uint16_t>(rec.size());
+        if (len <= s.length) {
+            memcpy(data.data() + s.offset, rec.data(), len);
+            s.length = len;
+            setSlot(slotID, s);
+            return true;
+        }
+        // the slot already exists, so only the record bytes need room
+        if (freeSpace() < len) return false;
+        uint16_t offset = freeSpaceOffset();
+        memcpy(data.data() + offset, rec.data(), len);
+        s.offset = offset;
+        s.length = len;
+        setSlot(slotID, s);
+        setFreeSpaceOffset(static_cast<uint16_t>(offset + len));
+        return true;
+    }
+
+    bool Page::setForward(uint16_t slotID, const RecordLocation& target) {
+        vector<uint8_t> stub(FORWARD_BYTES);
+        memcpy(stub.data(), &target.pageIndex, 4);
+        memcpy(stub.data() + 4, &target.slotID, 2);
+        if (!replaceRecord(slotID, stub)) return false;
+        setSlotState(slotID, SLOT_FORWARD);
+        return true;
+    }
+
+    optional<RecordLocation> Page::linkedLocation(uint16_t slotID) const {
+        if (slotID >= slotCount()) return nullopt;
+        SlotEntry s = slot(slotID);
+        if ((s.state != SLOT_FORWARD && s.state != SLOT_MOVED) || s.length < FORWARD_BYTES) return nullopt;
+        RecordLocation loc;
+        memcpy(&loc.pageIndex, data.data() + s.offset, 4);
+        memcpy(&loc.slotID, data.data() + s.offset + 4, 2);
+        return loc;
+    }
+
+    uint32_t Page::liveBytes() const {
+        uint32_t total = 0;
+        for (uint16_t i = 0; i < slotCount(); ++i) {
+            SlotEntry s = slot(i);
+            if (s.state != SLOT_DEAD) total += s.length;
+        }
+        return total;
+    }
+
+    uint32_t Page::deadBytes() const {
+        uint32_t used = freeSpaceOffset() > PAGE_HEADER_RESERVED ? freeSpaceOffset() - PAGE_HEADER_RESERVED : 0;
+        uint32_t live = liveBytes();
+        return (used > live ? used - live : 0) + deadSlots() * SLOT_ENTRY_BYTES;
+    }
+
+    void Page::compact() {
+        // trailing dead entries go: the rest of the directory moves up past them
+        uint16_t n = slotCount();
+        uint16_t dead = deadSlots();
+        uint16_t trailing = 0;
+        while (trailing < n && slot(n - 1 - trailing).state == SLOT_DEAD) trailing++;
+        if (trailing > 0) {
+            uint8_t* directory = data.data() + data.size() - static_cast<size_t>(SLOT_ENTRY_BYTES) * n;
+            memmove(directory + static_cast<size_t>(SLOT_ENTRY_BYTES) * trailing, directory,
+                    static_cast<size_t>(SLOT_ENTRY_BYTES) * (n - trailing));
+            n = static_cast<uint16_t>(n - trailing);
+            dead = static_cast<uint16_t>(dead - min(dead, trailing));
+            setSlotCount(n);
+        }
+
+        array<uint8_t, MAX_PAGE_SIZE> packed;
+        uint16_t pos = PAGE_HEADER_RESERVED;
+        for (uint16_t i = 0; i < n; ++i) {
+            SlotEntry s = slot(i);
+            if (s.state == SLOT_DEAD) {
+                setSlot(i, SlotEntry(0, 0, SLOT_DEAD));
+                continue;
+            }
+            memcpy(packed.data() + pos, data.data() + s.offset, s.length);
+            s.offset = pos;
+            setSlot(i, s);
+            pos += s.length;
+        }
+        size_t directoryStart = data.size() - static_cast<size_t>(SLOT_ENTRY_BYTES) * n;
+        memcpy(data.data() + PAGE_HEADER_RESERVED, packed.data() + PAGE_HEADER_RESERVED, pos - PAGE_HEADER_RESERVED);
+        memset(data.data() + pos, 0, directoryStart - pos);
+        setFreeSpaceOffset(pos);
+        setDeadSlots(dead);
+    }
+
+    void Page::serializeToBuffer(vector<uint8_t>& buffer) const {
+        buffer.assign(data.begin(), data.end());
+    }
+
+    void Page::serializeToBuffer(uint8_t* buffer) const {
+        memcpy(buffer, data.data(), data.size());
+    }
+
+    void Page::deserializeFromBuffer(const vector<uint8_t>& buffer) {
+        if (buffer.size() < data.size()) return;
+        deserializeFromBuffer(buffer.data());
+    }
+
+    void Page::deserializeFromBuffer(const uint8_t* buffer) {
+        memcpy(data.data(), buffer, data.size());
+        checkHeader();
+    }
+
+    void Page::checkHeader() {
+        uint16_t n = slotCount();
+        if (n > (size() - PAGE_HEADER_RESERVED) / SLOT_ENTRY_BYTES) setSlotCount(n = 0);
+        size_t directoryStart = data.size() - static_cast<size_t>(SLOT_ENTRY_BYTES) * n;
+        if (freeSpaceOffset() < PAGE_HEADER_RESERVED) setFreeSpaceOffset(PAGE_HEADER_RESERVED);
+        if (freeSpaceOffset() > directoryStart) setFreeSpaceOffset(static_cast<uint16_t>(directoryStart));
+    }
+
+    // ---------- PageView ----------
+    uint16_t PageView::slotCount() const {
+        uint16_t n = 0;
+        memcpy(&n, bytes + 8, sizeof(n));
+        if (n * SLOT_ENTRY_BYTES > pageSize - PAGE_HEADER_RESERVED) return 0; // corrupt / not a slotted page
+        return n;
+    }
+
+    SlotEntry PageView::slot(uint16_t slotID) const {
+        size_t pos = pageSize - static_cast<size_t>(SLOT_ENTRY_BYTES) * (slotCount() - slotID);
+        uint16_t len = 0, off = 0;
+        memcpy(&len, bytes + pos + 1, 2);
+        memcpy(&off, bytes + pos + 3, 2);
+        if (off + static_cast<uint32_t>(len) > pageSize) return SlotEntry(0, 0, SLOT_DEAD);
+        SlotEntry e(off, len, bytes[pos]);
+        if (e.state == SLOT_MOVED && len < FORWARD_BYTES) e.state = SLOT_DEAD; // corrupt
+        return e;
+    }
+
+} // namespace ChronoDB
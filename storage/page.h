@@ -0,0 +1,182 @@
+#ifndef CHRONODB_PAGE_H
+#define CHRONODB_PAGE_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <optional>
+using namespace std;
+
+namespace ChronoDB {
+
+    // -------- Page Constants --------
+    // Every table picks its page size at CREATE TABLE time (TableInfo::pageSize):
+    // a power of two from MIN_PAGE_SIZE to MAX_PAGE_SIZE. Slot offsets and lengths
+    // are u16, which is enough for 64 KB because the slot directory always sits
+    // at the end of the page, so no record byte or free offset reaches 65536.
+    static constexpr uint32_t DEFAULT_PAGE_SIZE = 8192; // 8 KB
+    static constexpr uint32_t MIN_PAGE_SIZE = 4096;
+    static constexpr uint32_t MAX_PAGE_SIZE = 65536;
+    inline bool isValidPageSize(uint32_t size) {
+        return size >= MIN_PAGE_SIZE && size <= MAX_PAGE_SIZE && (size & (size - 1)) == 0;
+    }
+    static constexpr uint16_t PAGE_HEADER_RESERVED = 64;
+    // Header layout: pageID @0, slotCount @8, freeSpaceOffset @10, dead slot
+    // entries + 1 @12 (0: not counted yet), pageLSN @16, then bytes 24..63 for the
+    // page type's own header (B+Tree node type and links)
+    static constexpr uint16_t PAGE_SLOT_COUNT_OFFSET = 8;
+    static constexpr uint16_t PAGE_FREE_OFFSET = 10;
+    static constexpr uint16_t PAGE_DEAD_SLOTS_OFFSET = 12;
+    static constexpr uint16_t PAGE_LSN_OFFSET = 16;
+    static constexpr uint16_t PAGE_AUX_OFFSET = 24;
+    // Slot directory entry: state u8, length u16, offset u16
+    static constexpr uint16_t SLOT_ENTRY_BYTES = 5;
+
+    // O_DIRECT needs the buffer address, file offset and length of every read and
+    // write to be multiples of the device block size; 4 KB covers common devices
+    static constexpr size_t PAGE_ALIGNMENT = 4096;
+
+    template <typename T>
+    struct PageAlignedAllocator {
+        using value_type = T;
+        PageAlignedAllocator() = default;
+        template <typename U> PageAlignedAllocator(const PageAlignedAllocator<U>&) {}
+        T* allocate(size_t n) { return static_cast<T*>(::operator new(n * sizeof(T), align_val_t(PAGE_ALIGNMENT))); }
+        void deallocate(T* p, size_t) { ::operator delete(p, align_val_t(PAGE_ALIGNMENT)); }
+        template <typename U> bool operator==(const PageAlignedAllocator<U>&) const { return true; }
+        template <typename U> bool operator!=(const PageAlignedAllocator<U>&) const { return false; }
+    };
+    // Buffer for page file I/O (one or more pages)
+    using PageBuffer = vector<uint8_t, PageAlignedAllocator<uint8_t>>;
+
+    // Slot states (the state byte of each on-disk slot entry)
+    static constexpr uint8_t SLOT_DEAD = 0;      // deleted; bytes reclaimed by VACUUM
+    static constexpr uint8_t SLOT_LIVE = 1;      // record stored in its home slot
+    static constexpr uint8_t SLOT_FORWARD = 2;   // stub: record moved to (page u32, slot u16)
+    static constexpr uint8_t SLOT_MOVED = 3;     // relocated record: home (page u32, slot u16) + record
+    static constexpr uint16_t FORWARD_BYTES = 6;
+
+    struct SlotEntry {
+        uint16_t offset;
+        uint16_t length;
+        uint8_t state;
+        SlotEntry(uint16_t o = 0, uint16_t l = 0, uint8_t s = SLOT_LIVE)
+            : offset(o), length(l), state(s) {}
+
+        // Holds a record a scan should return (stubs and dead slots do not)
+        bool holdsRecord() const { return state == SLOT_LIVE || state == SLOT_MOVED; }
+        // Where the record bytes start, past the home pointer of a moved record
+        uint16_t recordOffset() const { return state == SLOT_MOVED ? offset + FORWARD_BYTES : offset; }
+        uint16_t recordLength() const { return state == SLOT_MOVED ? length - FORWARD_BYTES : length; }
+    };
+
+    // Record ID: page index + slot within the page
+    struct RecordLocation {
+        uint32_t pageIndex = 0;
+        uint16_t slotID = 0;
+    };
+
+    // One page in its on-disk layout: a single aligned buffer of size() bytes whose
+    // header fields and slot directory are read and written in place, so loading
+    // or saving a page is one memcpy (none when it is read straight into a buffer
+    // pool frame). Record bytes grow up from PAGE_HEADER_RESERVED; the directory
+    // grows down from the end of the page, slot 0 lowest: slot i of n is the
+    // SLOT_ENTRY_BYTES at size() - SLOT_ENTRY_BYTES * (n - i).
+    struct Page {
+        PageBuffer data;
+
+        explicit Page(uint32_t pageSize = DEFAULT_PAGE_SIZE);
+        uint32_t size() const { return static_cast<uint32_t>(data.size()); }
+        // Empty page of pageSize bytes (the buffer is reused when it has that size)
+        void reset(uint32_t pageSize);
+        void reset() { reset(size()); }
+
+        uint32_t pageID() const { return load<uint32_t>(0); }
+        void setPageID(uint32_t id) { store<uint32_t>(0, id); }
+        // LSN of the last log record applied to this page
+        uint64_t pageLSN() const { return load<uint64_t>(PAGE_LSN_OFFSET); }
+        void setPageLSN(uint64_t lsn) { store<uint64_t>(PAGE_LSN_OFFSET, lsn); }
+        uint16_t slotCount() const { return load<uint16_t>(PAGE_SLOT_COUNT_OFFSET); }
+        uint16_t freeSpaceOffset() const { return load<uint16_t>(PAGE_FREE_OFFSET); }
+        void setFreeSpaceOffset(uint16_t offset) { store<uint16_t>(PAGE_FREE_OFFSET, offset); }
+
+        // Slot directory entries (slotID < slotCount())
+        SlotEntry slot(uint16_t slotID) const {
+            size_t pos = slotPosition(slotID);
+            return SlotEntry(load<uint16_t>(pos + 3), load<uint16_t>(pos + 1), data[pos]);
+        }
+        void setSlot(uint16_t slotID, const SlotEntry& entry);
+        void setSlotState(uint16_t slotID, uint8_t state) { data[slotPosition(slotID)] = state; }
+        // Adds an entry as slot pos, renumbering the slots from pos on (B+Tree nodes
+        // keep their slots in key order); eraseSlot drops the entry but not its bytes
+        void insertSlot(uint16_t pos, const SlotEntry& entry);
+        void eraseSlot(uint16_t pos);
+
+        uint16_t usedDataBytes() const { return freeSpaceOffset(); }
+        uint16_t freeSpace() const;
+        optional<uint16_t> insertRawRecord(const vector<uint8_t>& rec, uint8_t state = SLOT_LIVE);
+        bool deleteSlot(uint16_t slotID);
+        bool readRawRecord(uint16_t slotID, vector<uint8_t>& out) const;
+        // Replaces the slot's bytes, keeping its slot ID and state: in place when the
+        // new bytes fit the old length, else in the page's free space. False if neither.
+        bool replaceRecord(uint16_t slotID, const vector<uint8_t>& rec);
+        // Turns the slot into a forwarding stub to another record location
+        bool setForward(uint16_t slotID, const RecordLocation& target);
+        // Target of a forwarding stub, or home of a moved record
+        optional<RecordLocation> linkedLocation(uint16_t slotID) const;
+
+        // Bytes held by slots that are not dead (records, stubs, moved records)
+        uint32_t liveBytes() const;
+        // Bytes VACUUM can reclaim: dead records, orphaned bytes and dead slot entries
+        uint32_t deadBytes() const;
+        // Packs the bytes of the non-dead slots together (slot IDs are kept) and drops
+        // trailing dead slot entries
+        void compact();
+
+        // The page is its own image: these copy size() bytes out / in
+        void serializeToBuffer(vector<uint8_t>& buffer) const;
+        void deserializeFromBuffer(const vector<uint8_t>& buffer);
+        void serializeToBuffer(uint8_t* buffer) const;
+        void deserializeFromBuffer(const uint8_t* buffer);
+        // After an image was read into data directly: an all-zero page (read past the
+        // end of a file) or a damaged header gets a directory and record area that
+        // stay inside the page and apart
+        void checkHeader();
+
+    private:
+        template <typename T> T load(size_t at) const {
+            T v;
+            memcpy(&v, data.data() + at, sizeof(T));
+            return v;
+        }
+        template <typename T> void store(size_t at, T v) { memcpy(data.data() + at, &v, sizeof(T)); }
+
+        size_t slotPosition(uint16_t slotID) const {
+            return data.size() - static_cast<size_t>(SLOT_ENTRY_BYTES) * (slotCount() - slotID);
+        }
+        void setSlotCount(uint16_t n) { store<uint16_t>(PAGE_SLOT_COUNT_OFFSET, n); }
+        // Dead slot entries available for reuse. Pages written before the count was
+        // kept hold 0 there and are counted on first use.
+        uint16_t deadSlots() const;
+        void setDeadSlots(uint16_t n) { store<uint16_t>(PAGE_DEAD_SLOTS_OFFSET, static_cast<uint16_t>(n + 1)); }
+    };
+
+    // Read-only accessor over a serialised page (e.g. straight out of an mmap).
+    // Nothing is copied: the slot directory and record bytes are read in place.
+    struct PageView {
+        const uint8_t* bytes;
+        uint32_t pageSize;
+
+        explicit PageView(const uint8_t* pageBytes, uint32_t size = DEFAULT_PAGE_SIZE) : bytes(pageBytes), pageSize(size) {}
+
+        uint16_t slotCount() const;
+        // Slot i sits (slotCount - i) entries below the end of the page
+        SlotEntry slot(uint16_t slotID) const;
+        const uint8_t* record(const SlotEntry& s) const { return bytes + s.recordOffset(); }
+    };
+
+} // namespace ChronoDB
+
+#endif // CHRONODB_PAGE_H
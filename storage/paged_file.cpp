@@ -0,0 +1,214 @@
+// paged_file.cpp
+#include "paged_file.h"
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace ChronoDB {
+
+#ifdef _WIN32
+    // MinGW has no pread/pwrite; emulate them with a seek (the engine is single-threaded per file)
+    static long long positionalRead(int fd, void* buf, size_t n, long long off) {
+        if (_lseeki64(fd, off, SEEK_SET) < 0) return -1;
+        return _read(fd, buf, static_cast<unsigned>(n));
+    }
+    static long long positionalWrite(int fd, const void* buf, size_t n, long long off) {
+        if (_lseeki64(fd, off, SEEK_SET) < 0) return -1;
+        return _write(fd, buf, static_cast<unsigned>(n));
+    }
+#else
+    static long long positionalRead(int fd, void* buf, size_t n, long long off) {
+        return ::pread(fd, buf, n, static_cast<off_t>(off));
+    }
+    static long long positionalWrite(int fd, const void* buf, size_t n, long long off) {
+        return ::pwrite(fd, buf, n, static_cast<off_t>(off));
+    }
+#endif
+
+    PagedFile::~PagedFile() {
+        close();
+    }
+
+    bool PagedFile::open(const string& path, bool create, bool wantDirect, uint32_t pageSize) {
+        close();
+        pageBytes = pageSize;
+        int flags = O_RDWR;
+        if (create) flags |= O_CREAT;
+#ifdef _WIN32
+        (void)wantDirect;
+        flags |= O_BINARY;
+        fd = ::_open(path.c_str(), flags, _S_IREAD | _S_IWRITE);
+#else
+#ifdef O_DIRECT
+        // tmpfs and some other file systems refuse O_DIRECT with EINVAL
+        if (wantDirect) {
+            fd = ::open(path.c_str(), flags | O_DIRECT, 0644);
+            direct = fd >= 0;
+        }
+#endif
+        if (fd < 0) fd = ::open(path.c_str(), flags, 0644);
+#endif
+        if (fd < 0) return false;
+
+        // The only size lookup: afterwards the page count is maintained in memory
+        struct stat st;
+        if (fstat(fd, &st) != 0) { close(); return false; }
+        pages = static_cast<uint32_t>((st.st_size + pageBytes - 1) / pageBytes);
+        return true;
+    }
+
+    void PagedFile::close() {
+        unmap();
+        if (fd < 0) return;
+#ifdef _WIN32
+        ::_close(fd);
+#else
+        ::close(fd);
+#endif
+        fd = -1;
+        direct = false;
+        pages = 0;
+    }
+
+    bool PagedFile::readPage(uint32_t pageIndex, uint8_t* buffer) const {
+        return readPages(pageIndex, 1, buffer);
+    }
+
+    static bool aligned(const uint8_t* buffer) {
+        return reinterpret_cast<uintptr_t>(buffer) % PAGE_ALIGNMENT == 0;
+    }
+
+    bool PagedFile::readPages(uint32_t firstPage, uint32_t count, uint8_t* buffer) const {
+        if (fd < 0) return false;
+        long long off = static_cast<long long>(firstPage) * pageBytes;
+        size_t want = static_cast<size_t>(count) * pageBytes;
+        if (direct && !aligned(buffer)) {
+            PageBuffer bounce(want);
+            if (!readPages(firstPage, count, bounce.data())) return false;
+            memcpy(buffer, bounce.data(), want);
+            return true;
+        }
+        long long n = positionalRead(fd, buffer, want, off);
+        if (n < 0) return false;
+        // a short read past the end behaves like the old ifstream path: zero-filled pages
+        if (static_cast<size_t>(n) < want) memset(buffer + n, 0, want - static_cast<size_t>(n));
+        return true;
+    }
+
+    bool PagedFile::writePage(uint32_t pageIndex, const uint8_t* buffer) {
+        if (fd < 0) return false;
+        if (direct && !aligned(buffer)) {
+            PageBuffer bounce(buffer, buffer + pageBytes);
+            return writePage(pageIndex, bounce.data());
+        }
+        long long off = static_cast<long long>(pageIndex) * pageBytes;
+        writes++;
+        if (positionalWrite(fd, buffer, pageBytes, off) != static_cast<long long>(pageBytes)) return false;
+        if (pageIndex >= pages) pages = pageIndex + 1;
+        return true;
+    }
+
+    optional<uint32_t> PagedFile::appendPage(const uint8_t* buffer) {
+        uint32_t index = pages;
+        if (!writePage(index, buffer)) return nullopt;
+        return index;
+    }
+
+    bool PagedFile::truncate(uint32_t pageCount) {
+        if (fd < 0) return false;
+        long long size = static_cast<long long>(pageCount) * pageBytes;
+        unmap();
+        writes++;
+#ifdef _WIN32
+        if (_chsize_s(fd, size) != 0) return false;
+#else
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0) return false;
+#endif
+        pages = pageCount;
+        return true;
+    }
+
+    bool PagedFile::sync() {
+        if (fd < 0) return false;
+#ifdef _WIN32
+        return _commit(fd) == 0;
+#else
+        return fsync(fd) == 0;
+#endif
+    }
+
+    const uint8_t* PagedFile::mapPages(bool sequential) {
+#ifdef _WIN32
+        (void)sequential;
+        return nullptr;
+#else
+        if (fd < 0 || pages == 0) return nullptr;
+        size_t want = static_cast<size_t>(pages) * pageBytes;
+        if (mapping && mappedBytes == want) return static_cast<const uint8_t*>(mapping);
+
+        unmap();
+        void* m = mmap(nullptr, want, PROT_READ, MAP_SHARED, fd, 0);
+        if (m == MAP_FAILED) return nullptr;
+        mapping = m;
+        mappedBytes = want;
+        madvise(mapping, mappedBytes, sequential ? MADV_SEQUENTIAL : MADV_NORMAL);
+        return static_cast<const uint8_t*>(mapping);
+#endif
+    }
+
+    void PagedFile::unmap() {
+#ifndef _WIN32
+        if (mapping) munmap(mapping, mappedBytes);
+#endif
+        mapping = nullptr;
+        mappedBytes = 0;
+    }
+
+    bool replaceFile(const string& path, const vector<uint8_t>& bytes) {
+        string tmpPath = path + ".tmp";
+#ifdef _WIN32
+        int fd = ::_open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+        int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+        if (fd < 0) return false;
+        size_t done = 0;
+        while (done < bytes.size()) {
+            long long n = positionalWrite(fd, bytes.data() + done, bytes.size() - done, static_cast<long long>(done));
+            if (n <= 0) break;
+            done += static_cast<size_t>(n);
+        }
+        bool ok = done == bytes.size();
+#ifdef _WIN32
+        ok = ok && _commit(fd) == 0;
+        ::_close(fd);
+#else
+        ok = ok && fsync(fd) == 0;
+        ::close(fd);
+#endif
+        if (!ok) return false;
+
+        error_code ec;
+        fs::rename(tmpPath, path, ec);
+        if (ec) return false;
+#ifndef _WIN32
+        // the rename itself is only durable once the directory entry is
+        string dir = fs::path(path).parent_path().string();
+        int dirFd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY);
+        if (dirFd < 0) return false;
+        ok = fsync(dirFd) == 0;
+        ::close(dirFd);
+#endif
+        return ok;
+    }
+
+} // namespace ChronoDB
@@ -0,0 +1,75 @@
+#ifndef CHRONODB_PAGED_FILE_H
+#define CHRONODB_PAGED_FILE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include "page.h"
+using namespace std;
+
+namespace ChronoDB {
+
+    // One open descriptor on a .tbl file. Pages are read and written with
+    // positional I/O (pread/pwrite) at pageIndex * pageSize(), and the page
+    // count is tracked in memory so the hot path never re-opens or stats the file.
+    // Opened for direct I/O (O_DIRECT) the reads and writes bypass the OS page
+    // cache; callers should then pass PageBuffer memory, anything else is copied
+    // through an aligned buffer.
+    class PagedFile {
+    public:
+        PagedFile() = default;
+        ~PagedFile();
+        PagedFile(const PagedFile&) = delete;
+        PagedFile& operator=(const PagedFile&) = delete;
+
+        // direct: try O_DIRECT, falling back to cached I/O where the platform or
+        // file system does not support it (see isDirect). pageSize is the owning
+        // table's; the file itself does not record it.
+        bool open(const string& path, bool create, bool direct = false, uint32_t pageSize = DEFAULT_PAGE_SIZE);
+        void close();
+        bool isOpen() const { return fd >= 0; }
+        bool isDirect() const { return direct; }
+        uint32_t pageSize() const { return pageBytes; }
+
+        uint32_t pageCount() const { return pages; }
+        // Bumped by every write and truncate: bytes read earlier are stale once it changes
+        uint64_t writeCount() const { return writes; }
+
+        // buffer must hold pageSize() bytes
+        bool readPage(uint32_t pageIndex, uint8_t* buffer) const;
+        // count consecutive pages in one read (buffer holds count * pageSize() bytes);
+        // safe to call from another thread while this one writes other pages (POSIX)
+        bool readPages(uint32_t firstPage, uint32_t count, uint8_t* buffer) const;
+        bool writePage(uint32_t pageIndex, const uint8_t* buffer);
+        // Writes the buffer past the last page and returns its index; nullopt if
+        // the write failed (the file keeps its page count)
+        optional<uint32_t> appendPage(const uint8_t* buffer);
+
+        bool truncate(uint32_t pageCount);
+        bool sync();
+
+        // Read-only mapping of every page currently in the file (remapped when the
+        // file has grown). Returns nullptr where mmap is unavailable. With
+        // sequential=true the kernel is told to read ahead aggressively.
+        const uint8_t* mapPages(bool sequential);
+        void unmap();
+
+    private:
+        int fd = -1;
+        bool direct = false;
+        uint32_t pageBytes = DEFAULT_PAGE_SIZE;
+        uint32_t pages = 0;
+        uint64_t writes = 0;
+
+        void* mapping = nullptr;
+        size_t mappedBytes = 0;
+    };
+
+    // Writes bytes to path + ".tmp", syncs it, renames it over path and syncs the
+    // directory, so even a power loss leaves either the old or the new file
+    bool replaceFile(const string& path, const vector<uint8_t>& bytes);
+
+} // namespace ChronoDB
+
+#endif // CHRONODB_PAGED_FILE_H
@@ -0,0 +1,151 @@
+// primary_index.cpp
+#include "storage.h"
+#include <cstring>
+#include <algorithm>
+using namespace std;
+
+namespace ChronoDB {
+
+    // ---------- Primary-key index ----------
+    // Every HEAP table with a schema has <table>.idx: a BPlusTree from the INT
+    // primary key to the record's home location (page u32 + slot u16). The home
+    // slot never changes when a record grows and moves (it becomes a forwarding
+    // stub), so only inserts, deletes, key changes and VACUUM touch the index.
+    //
+    // The index is not write-ahead logged. Its meta page carries a clean flag that
+    // is set at each sharp checkpoint and cleared on disk before the first change
+    // after it; an index found unclean (or missing) is rebuilt from the heap.
+
+    static vector<uint8_t> encodeLocation(const RecordLocation& loc) {
+        vector<uint8_t> v(FORWARD_BYTES);
+        memcpy(v.data(), &loc.pageIndex, 4);
+        memcpy(v.data() + 4, &loc.slotID, 2);
+        return v;
+    }
+
+    BPlusTree* StorageEngine::primaryIndex(const string& tableName) {
+        auto it = primaryIndexes.find(tableName);
+        if (it != primaryIndexes.end()) return it->second.get();
+        const TableInfo* table = catalog.find(tableName);
+        if (!table || table->structure != StructureType::HEAP || table->columns.empty() || !tableFile(tableName)) return nullptr;
+
+        string key = indexFileKey(tableName);
+        PagedFile* file = tableFile(key, true);
+        if (!file) return nullptr;
+        auto allocator = [this, key]() { return appendEmptyPage(key); };
+        auto index = make_unique<BPlusTree>(bufferPool, key, allocator);
+        if (!index->open(file->pageCount()) || !index->isClean()) {
+            // start over from an empty file so no stale node survives the rebuild
+            bufferPool.discardPages(key, 0);
+            file->truncate(0);
+            index = make_unique<BPlusTree>(bufferPool, key, allocator);
+            index->open(0);
+            rebuildPrimaryIndex(tableName, *index);
+        }
+        BPlusTree* raw = index.get();
+        primaryIndexes[tableName] = move(index);
+        return raw;
+    }
+
+    // One pass over the heap collecting (id, home) pairs, then a bottom-up bulk load
+    void StorageEngine::rebuildPrimaryIndex(const string& tableName, BPlusTree& index) {
+        vector<pair<int32_t, vector<uint8_t>>> entries;
+        const RecordCodec& codec = codecFor(tableName);
+        uint32_t pages = pageCount(tableName);
+        for (uint32_t i = 0; i < pages; ++i) {
+            PageHandle p(bufferPool, tableName, i);
+            if (!p.valid()) break;
+            for (uint16_t s = 0; s < p->slotCount(); ++s) {
+                SlotEntry e = p->slot(s);
+                if (!e.holdsRecord()) continue;
+                int id = 0;
+                if (!codec.peekId(p->data.data() + e.recordOffset(), e.recordLength(), id)) continue;
+                optional<RecordLocation> home = RecordLocation{i, s};
+                if (e.state == SLOT_MOVED) home = p->linkedLocation(s);
+                if (home.has_value()) entries.emplace_back(id, encodeLocation(*home));
+            }
+        }
+        // a crash between the steps of a multi-page change can leave a duplicate: keep one
+        stable_sort(entries.begin(), entries.end(),
+                    [](const auto& a, const auto& b) { return a.first < b.first; });
+        entries.erase(unique(entries.begin(), entries.end(),
+                             [](const auto& a, const auto& b) { return a.first == b.first; }),
+                      entries.end());
+        index.bulkLoad(entries);
+    }
+
+    // The index about to change: its clean flag is cleared and made durable first
+    BPlusTree* StorageEngine::primaryIndexForWrite(const string& tableName) {
+        BPlusTree* index = primaryIndex(tableName);
+        if (!index || !index->isClean()) return index;
+        string key = indexFileKey(tableName);
+        index->setClean(false);
+        bufferPool.flushPage(key, 0);
+        if (PagedFile* file = tableFile(key)) file->sync();
+        return index;
+    }
+
+    // Called by flush() once every page is written and synced
+    void StorageEngine::markIndexesClean() {
+        for (auto& entry : primaryIndexes) {
+            if (entry.second->isClean()) continue;
+            string key = indexFileKey(entry.first);
+            entry.second->setClean(true);
+            bufferPool.flushPage(key, 0);
+            if (PagedFile* file = tableFile(key)) file->sync();
+        }
+    }
+
+    void StorageEngine::indexPut(const string& tableName, int id, const RecordLocation& home) {
+        if (BPlusTree* index = primaryIndexForWrite(tableName)) index->put(id, encodeLocation(home));
+    }
+
+    void StorageEngine::indexRemove(const string& tableName, int id) {
+        if (BPlusTree* index = primaryIndexForWrite(tableName)) index->remove(id);
+    }
+
+    // Index lookup; the entry is trusted only if the slot it leads to (after at most
+    // one forwarding hop) still holds a record with this id.
+    optional<RecordLocation> StorageEngine::locateRecord(const string& tableName, int id) {
+        BPlusTree* index = primaryIndex(tableName);
+        if (!index) {
+            // no schema (legacy table): walk the pages
+            optional<RecordLocation> found;
+            const RecordCodec& codec = codecFor(tableName);
+            scanHeap(tableName, [&](uint32_t page, uint16_t slot, const uint8_t* raw, uint16_t len) {
+                int key = 0;
+                if (codec.peekId(raw, len, key) && key == id) {
+                    found = RecordLocation{page, slot};
+                    return false;
+                }
+                return true;
+            });
+            return found;
+        }
+
+        optional<vector<uint8_t>> value = index->get(id);
+        if (!value.has_value() || value->size() != FORWARD_BYTES) return nullopt;
+        RecordLocation loc;
+        memcpy(&loc.pageIndex, value->data(), 4);
+        memcpy(&loc.slotID, value->data() + 4, 2);
+
+        for (int hop = 0; hop < 2; ++hop) {
+            if (loc.pageIndex >= pageCount(tableName)) return nullopt;
+            PageHandle p(bufferPool, tableName, loc.pageIndex);
+            if (!p.valid() || loc.slotID >= p->slotCount()) return nullopt;
+            SlotEntry e = p->slot(loc.slotID);
+            if (e.state == SLOT_FORWARD) {
+                optional<RecordLocation> target = p->linkedLocation(loc.slotID);
+                if (!target.has_value()) return nullopt;
+                loc = *target;
+                continue;
+            }
+            int key = 0;
+            if (!e.holdsRecord() || !codecFor(tableName).peekId(p->data.data() + e.recordOffset(), e.recordLength(), key) || key != id)
+                return nullopt;
+            return loc;
+        }
+        return nullopt;
+    }
+
+} // namespace ChronoDB
@@ -0,0 +1,70 @@
+// read_ahead.cpp
+#include "read_ahead.h"
+#include <algorithm>
+#include <chrono>
+using namespace std;
+
+namespace ChronoDB {
+
+    void ReadAhead::advance(uint32_t pageIndex) {
+        // going back (another cursor, a new scan) is not the same sequential scan: start
+        // over small; a write to the file since the oldest run may have made any run stale.
+        // Going forward past pages that were cached is still the same scan.
+        bool jumped = pageIndex < last;
+        if (jumped || (!runs.empty() && runs.front().writes != file.writeCount())) {
+            reset();
+            nextIssue = pageIndex;
+            if (jumped) window = MIN_WINDOW_PAGES;
+        }
+        last = pageIndex;
+
+        while (!runs.empty() && runs.front().first + runs.front().count <= pageIndex) runs.pop_front();
+        nextIssue = max(nextIssue, pageIndex);
+        uint32_t end = file.pageCount();
+        while (nextIssue < end && nextIssue - pageIndex < 2 * window) issue(min(window, end - nextIssue));
+    }
+
+    const uint8_t* ReadAhead::page(uint32_t pageIndex) {
+        for (Run& r : runs) {
+            if (pageIndex < r.first || pageIndex - r.first >= r.count) continue;
+            if (r.reading.valid()) {
+                // waiting means the disk is behind the scan: read further ahead from now on
+                if (r.reading.wait_for(chrono::seconds(0)) != future_status::ready) {
+                    stallCount++;
+                    window = min(window * 2, maxWindowPages());
+                }
+                r.ok = r.reading.get();
+            }
+            if (!r.ok || r.writes != file.writeCount()) return nullptr;
+            return r.bytes.data() + static_cast<size_t>(pageIndex - r.first) * file.pageSize();
+        }
+        return nullptr;
+    }
+
+    void ReadAhead::reset() {
+        for (Run& r : runs)
+            if (r.reading.valid()) r.reading.wait();
+        runs.clear();
+    }
+
+    void ReadAhead::issue(uint32_t count) {
+        Run r;
+        r.first = nextIssue;
+        r.count = count;
+        r.writes = file.writeCount();
+        r.bytes.resize(static_cast<size_t>(count) * file.pageSize());
+#ifdef _WIN32
+        // positional reads are emulated with a seek on the shared descriptor: read on first use instead
+        launch policy = launch::deferred;
+#else
+        launch policy = launch::async;
+#endif
+        const PagedFile* source = &file;
+        uint32_t first = r.first;
+        uint8_t* out = r.bytes.data();
+        r.reading = async(policy, [source, first, count, out] { return source->readPages(first, count, out); });
+        runs.push_back(move(r));
+        nextIssue += count;
+    }
+
+} // namespace ChronoDB
@@ -0,0 +1,67 @@
+#ifndef CHRONODB_READ_AHEAD_H
+#define CHRONODB_READ_AHEAD_H
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <vector>
+#include "page.h"
+#include "paged_file.h"
+using namespace std;
+
+namespace ChronoDB {
+
+    // Sequential read-ahead over one table file for a scan. Pages past the scan
+    // position are read in runs (one positional read of `window` pages each) on
+    // worker threads, so decoding the current page overlaps the I/O of the next
+    // ones. The window starts small and doubles every time the scan has to wait
+    // for a run, up to MAX_WINDOW_BYTES; a jump back in the scan position starts
+    // over with the smallest window. A run read before the file was last written is
+    // thrown away, so read-ahead never returns stale bytes.
+    class ReadAhead {
+    public:
+        static constexpr uint32_t MIN_WINDOW_PAGES = 4;
+        static constexpr uint32_t MAX_WINDOW_BYTES = 1024 * 1024;  // per run: 128 pages of 8 KB
+
+        explicit ReadAhead(const PagedFile& file) : file(file) {}
+        ~ReadAhead() { reset(); }
+        ReadAhead(const ReadAhead&) = delete;
+        ReadAhead& operator=(const ReadAhead&) = delete;
+
+        // The scan is about to read pageIndex from disk: drops the runs behind it
+        // and keeps up to two windows of pages from it on being read
+        void advance(uint32_t pageIndex);
+        // The bytes of the page (the file's page size of them) if a run holds it and
+        // the file has not been written since the run was issued; otherwise nullptr
+        const uint8_t* page(uint32_t pageIndex);
+
+        uint32_t windowPages() const { return window; }
+        uint32_t maxWindowPages() const { return max(MIN_WINDOW_PAGES, MAX_WINDOW_BYTES / file.pageSize()); }
+        // Times the scan waited for a run that was still being read
+        uint64_t stalls() const { return stallCount; }
+
+    private:
+        struct Run {
+            uint32_t first = 0;
+            uint32_t count = 0;
+            uint64_t writes = 0;          // file's write count when the run was issued
+            PageBuffer bytes;
+            future<bool> reading;
+            bool ok = false;
+        };
+
+        const PagedFile& file;
+        deque<Run> runs;                  // in page order
+        uint32_t last = 0;                // page of the previous advance()
+        uint32_t nextIssue = 0;           // first page not yet covered by a run
+        uint32_t window = MIN_WINDOW_PAGES;
+        uint64_t stallCount = 0;
+
+        void reset();
+        void issue(uint32_t count);
+    };
+
+} // namespace ChronoDB
+
+#endif // CHRONODB_READ_AHEAD_H
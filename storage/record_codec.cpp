@@ -0,0 +1,225 @@
+// record_codec.cpp
+#include "record_codec.h"
+#include <cstring>
+#include <algorithm>
+using namespace std;
+
+namespace ChronoDB {
+
+    // ---------- RecordCodec ----------
+    RecordCodec::RecordCodec(RecordFormat format, const vector<uint8_t>& typeTags) : fmt(format) {
+        if (fmt == RecordFormat::TAGGED) return;
+        tags = typeTags;
+        if (fmt == RecordFormat::FIXED) width = tags.size() * FIXED_FIELD_BYTES;
+    }
+
+    RecordFormat RecordCodec::formatFor(const vector<uint8_t>& typeTags, bool compact) {
+        if (typeTags.empty()) return RecordFormat::TAGGED;
+        if (compact) return RecordFormat::COMPACT;
+        for (uint8_t tag : typeTags) {
+            if (tag != TYPE_TAG_INT && tag != TYPE_TAG_FLOAT) return RecordFormat::TAGGED;
+        }
+        return RecordFormat::FIXED;
+    }
+
+    bool RecordCodec::encode(const Record& r, vector<uint8_t>& out) const {
+        if (fmt == RecordFormat::TAGGED) {
+            encodeTagged(r, out);
+            return true;
+        }
+        if (fmt == RecordFormat::COMPACT) return encodeCompact(r, out);
+        if (r.fields.size() != tags.size()) return false;
+        out.resize(width);
+        uint8_t* dst = out.data();
+        for (size_t i = 0; i < tags.size(); ++i, dst += FIXED_FIELD_BYTES) {
+            const RecordValue& v = r.fields[i];
+            if (v.index() != tags[i]) return false;
+            if (tags[i] == TYPE_TAG_INT) {
+                int32_t x = get<int>(v);
+                memcpy(dst, &x, 4);
+            } else {
+                float f = get<float>(v);
+                memcpy(dst, &f, 4);
+            }
+        }
+        return true;
+    }
+
+    bool RecordCodec::decode(const uint8_t* in, size_t size, Record& out) const {
+        if (fmt == RecordFormat::TAGGED) return decodeTagged(in, size, out);
+        if (fmt == RecordFormat::COMPACT) return decodeCompact(in, size, out);
+        out.fields.clear();
+        if (size != width) return false;
+        out.fields.reserve(tags.size());
+        for (size_t i = 0; i < tags.size(); ++i, in += FIXED_FIELD_BYTES) {
+            if (tags[i] == TYPE_TAG_INT) {
+                int32_t x;
+                memcpy(&x, in, 4);
+                out.fields.emplace_back(x);
+            } else {
+                float f;
+                memcpy(&f, in, 4);
+                out.fields.emplace_back(f);
+            }
+        }
+        return true;
+    }
+
+    bool RecordCodec::peekId(const uint8_t* raw, size_t len, int& id) const {
+        if (fmt == RecordFormat::TAGGED) return peekTaggedId(raw, len, id);
+        if (tags[0] != TYPE_TAG_INT) return false;
+        if (fmt == RecordFormat::COMPACT) {
+            uint32_t v = 0;
+            if (!readVarint(raw, raw + len, v)) return false;
+            id = unzigzag(v);
+            return true;
+        }
+        if (len != width) return false;
+        int32_t x;
+        memcpy(&x, raw, 4);
+        id = x;
+        return true;
+    }
+
+    size_t RecordCodec::readVarint(const uint8_t* in, const uint8_t* end, uint32_t& value) {
+        value = 0;
+        for (size_t i = 0; i < 5 && in + i < end; ++i) {
+            value |= static_cast<uint32_t>(in[i] & 0x7F) << (7 * i);
+            if (!(in[i] & 0x80)) return i + 1;
+        }
+        return 0;
+    }
+
+    void RecordCodec::putVarint(uint32_t value, vector<uint8_t>& out) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    // Reserved for the longest encoding, so the buffer is grown at most once
+    bool RecordCodec::encodeCompact(const Record& r, vector<uint8_t>& out) const {
+        if (r.fields.size() != tags.size()) return false;
+        size_t most = 0;
+        for (const RecordValue& v : r.fields)
+            most += holds_alternative<string>(v) ? 5 + get<string>(v).size() : 5;
+        out.clear();
+        out.reserve(most);
+
+        for (size_t i = 0; i < tags.size(); ++i) {
+            const RecordValue& v = r.fields[i];
+            if (v.index() != tags[i]) return false;
+            if (tags[i] == TYPE_TAG_INT) {
+                putVarint(zigzag(get<int>(v)), out);
+            } else if (tags[i] == TYPE_TAG_FLOAT) {
+                float f = get<float>(v);
+                const uint8_t* p = reinterpret_cast<const uint8_t*>(&f);
+                out.insert(out.end(), p, p + 4);
+            } else {
+                const string& s = get<string>(v);
+                // same cap as the TAGGED format's u16 length
+                size_t len = min<size_t>(s.size(), UINT16_MAX);
+                putVarint(static_cast<uint32_t>(len), out);
+                out.insert(out.end(), s.begin(), s.begin() + len);
+            }
+        }
+        return true;
+    }
+
+    bool RecordCodec::decodeCompact(const uint8_t* in, size_t size, Record& out) const {
+        out.fields.clear();
+        out.fields.reserve(tags.size());
+        const uint8_t* end = in + size;
+        for (uint8_t tag : tags) {
+            if (tag == TYPE_TAG_FLOAT) {
+                if (end - in < 4) return false;
+                float f; memcpy(&f, in, 4); in += 4;
+                out.fields.emplace_back(f);
+                continue;
+            }
+            uint32_t v = 0;
+            size_t n = readVarint(in, end, v);
+            if (!n) return false;
+            in += n;
+            if (tag == TYPE_TAG_INT) {
+                out.fields.emplace_back(unzigzag(v));
+            } else {
+                if (static_cast<size_t>(end - in) < v) return false;
+                out.fields.emplace_back(string(reinterpret_cast<const char*>(in), v));
+                in += v;
+            }
+        }
+        return in == end;
+    }
+
+    // Sized up front, so the buffer is grown once per record
+    void RecordCodec::encodeTagged(const Record& r, vector<uint8_t>& out) {
+        size_t total = 2;
+        for (const RecordValue& v : r.fields)
+            total += 1 + (holds_alternative<string>(v) ? 2 + get<string>(v).size() : 4);
+        out.resize(total);
+
+        uint8_t* dst = out.data();
+        uint16_t fieldCount = static_cast<uint16_t>(r.fields.size());
+        memcpy(dst, &fieldCount, 2);
+        dst += 2;
+        for (const RecordValue& v : r.fields) {
+            uint8_t typeTag = static_cast<uint8_t>(v.index());
+            *dst++ = typeTag;
+            if (typeTag == TYPE_TAG_INT) {
+                int32_t x = get<int>(v);
+                memcpy(dst, &x, 4);
+                dst += 4;
+            } else if (typeTag == TYPE_TAG_FLOAT) {
+                float f = get<float>(v);
+                memcpy(dst, &f, 4);
+                dst += 4;
+            } else {
+                const string& s = get<string>(v);
+                uint16_t len = static_cast<uint16_t>(s.size());
+                memcpy(dst, &len, 2);
+                memcpy(dst + 2, s.data(), len);
+                dst += 2 + len;
+            }
+        }
+        out.resize(dst - out.data()); // strings longer than a u16 length were cut
+    }
+
+    bool RecordCodec::decodeTagged(const uint8_t* in, size_t size, Record& out) {
+        out.fields.clear();
+        if (size < 2) return false;
+        uint16_t fieldCount = 0; memcpy(&fieldCount, in, 2);
+        size_t pos = 2;
+
+        for (uint16_t i = 0; i < fieldCount; ++i) {
+            if (pos >= size) return false;
+            uint8_t typeTag = in[pos]; pos += 1;
+            if (typeTag == TYPE_TAG_INT) {
+                if (pos + 4 > size) return false;
+                int32_t x; memcpy(&x, in + pos, 4); pos += 4;
+                out.fields.emplace_back(x);
+            } else if (typeTag == TYPE_TAG_FLOAT) {
+                if (pos + 4 > size) return false;
+                float f; memcpy(&f, in + pos, 4); pos += 4;
+                out.fields.emplace_back(f);
+            } else {
+                if (pos + 2 > size) return false;
+                uint16_t len = 0; memcpy(&len, in + pos, 2); pos += 2;
+                if (pos + len > size) return false;
+                out.fields.emplace_back(string(reinterpret_cast<const char*>(in + pos), len));
+                pos += len;
+            }
+        }
+        return true;
+    }
+
+    bool RecordCodec::peekTaggedId(const uint8_t* raw, size_t len, int& id) {
+        // layout: fieldCount(2) | tag(1) | int32(4) ...
+        if (len < 7 || raw[2] != TYPE_TAG_INT) return false;
+        int32_t x; memcpy(&x, raw + 3, 4);
+        id = x;
+        return true;
+    }
+
+} // namespace ChronoDB
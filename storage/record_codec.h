@@ -0,0 +1,84 @@
+#ifndef CHRONODB_RECORD_CODEC_H
+#define CHRONODB_RECORD_CODEC_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "../utils/types.h"
+using namespace std;
+
+namespace ChronoDB {
+
+    // Column types as record value tags (RecordValue alternative index, also the
+    // tag byte of each field in the TAGGED format)
+    static constexpr uint8_t TYPE_TAG_INT = 0;
+    static constexpr uint8_t TYPE_TAG_FLOAT = 1;
+    static constexpr uint8_t TYPE_TAG_STRING = 2;
+    static constexpr uint8_t TYPE_TAG_UNKNOWN = 0xFF;
+
+    // How the rows of a table are laid out on its pages. Chosen from the schema
+    // (and CREATE TABLE ... COMPACT) when the table is created and kept in the
+    // catalog; it never changes.
+    enum class RecordFormat : uint8_t {
+        // fieldCount u16, then per field a tag byte and int32 | float | (u16 length + bytes)
+        TAGGED = 0,
+        // INT/FLOAT-only schemas: the 4-byte values back to back, no header, no tags
+        FIXED = 1,
+        // opt-in: per column a zigzag varint (INT), a float, or a varint length +
+        // bytes (STRING); the schema stands in for the tags and field count
+        COMPACT = 2
+    };
+
+    // Encoder/decoder for one table's rows, built once from its schema. A FIXED
+    // codec knows every field's offset up front, so a row is one allocation to
+    // write and one load per field to read; a COMPACT codec trades that for
+    // smaller rows; a TAGGED codec handles any record.
+    class RecordCodec {
+    public:
+        RecordCodec() = default; // TAGGED
+        RecordCodec(RecordFormat format, const vector<uint8_t>& typeTags);
+
+        // COMPACT if asked for, else FIXED for a non-empty schema of INT and FLOAT
+        // columns only, else TAGGED
+        static RecordFormat formatFor(const vector<uint8_t>& typeTags, bool compact = false);
+
+        RecordFormat format() const { return fmt; }
+        // False if the record does not fit the format (wrong field count or type)
+        bool encode(const Record& r, vector<uint8_t>& out) const;
+        bool decode(const uint8_t* in, size_t size, Record& out) const;
+        bool decode(const vector<uint8_t>& in, Record& out) const { return decode(in.data(), in.size(), out); }
+        // The INT primary key (field 0) read straight from the bytes
+        bool peekId(const uint8_t* raw, size_t len, int& id) const;
+
+        // FIXED / COMPACT layout
+        size_t rowBytes() const { return width; }
+        size_t fieldCount() const { return tags.size(); }
+        uint8_t fieldTag(size_t i) const { return tags[i]; }
+        static constexpr size_t fieldOffset(size_t i) { return i * FIXED_FIELD_BYTES; }
+
+        // COMPACT field pieces: a LEB128 varint (0 if it runs past end or over 5 bytes)
+        // and the zigzag mapping that keeps small negative ints short
+        static size_t readVarint(const uint8_t* in, const uint8_t* end, uint32_t& value);
+        static void putVarint(uint32_t value, vector<uint8_t>& out);
+        static uint32_t zigzag(int32_t x) { return (static_cast<uint32_t>(x) << 1) ^ static_cast<uint32_t>(x >> 31); }
+        static int32_t unzigzag(uint32_t v) { return static_cast<int32_t>((v >> 1) ^ (0u - (v & 1))); }
+
+        // The self-describing TAGGED format, also used by files that outlive a schema (snapshots)
+        static void encodeTagged(const Record& r, vector<uint8_t>& out);
+        static bool decodeTagged(const uint8_t* in, size_t size, Record& out);
+        static bool peekTaggedId(const uint8_t* raw, size_t len, int& id);
+
+    private:
+        static constexpr size_t FIXED_FIELD_BYTES = 4;
+
+        RecordFormat fmt = RecordFormat::TAGGED;
+        vector<uint8_t> tags; // FIXED / COMPACT: TYPE_TAG_* of each column
+        size_t width = 0;     // FIXED: bytes per row
+
+        bool encodeCompact(const Record& r, vector<uint8_t>& out) const;
+        bool decodeCompact(const uint8_t* in, size_t size, Record& out) const;
+    };
+
+} // namespace ChronoDB
+
+#endif // CHRONODB_RECORD_CODEC_H
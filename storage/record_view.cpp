@@ -0,0 +1,161 @@
+// record_view.cpp
+#include "record_view.h"
+#include <cstring>
+using namespace std;
+
+namespace ChronoDB {
+
+    // ---------- RecordView ----------
+    // A FIXED row needs no parsing: the codec has every offset and type.
+    // A COMPACT row takes its types from the codec, but its varints have to be
+    // stepped over. A TAGGED row is fieldCount u16, then per field a tag byte
+    // followed by int32 | float | (u16 length + bytes).
+
+    bool RecordView::parse(const RecordCodec& codec, const uint8_t* in, size_t size) {
+        record = nullptr;
+        single = nullptr;
+        bytes = in;
+        offsets.clear();
+        if (codec.format() == RecordFormat::FIXED) {
+            schema = &codec;
+            return size == codec.rowBytes();
+        }
+        if (codec.format() == RecordFormat::COMPACT) {
+            schema = &codec;
+            const uint8_t* end = in + size;
+            const uint8_t* pos = in;
+            for (size_t i = 0; i < codec.fieldCount(); ++i) {
+                offsets.push_back(static_cast<uint32_t>(pos - in));
+                if (codec.fieldTag(i) == TYPE_TAG_FLOAT) {
+                    if (end - pos < 4) return false;
+                    pos += 4;
+                    continue;
+                }
+                uint32_t v = 0;
+                size_t n = RecordCodec::readVarint(pos, end, v);
+                if (!n) return false;
+                pos += n;
+                if (codec.fieldTag(i) == TYPE_TAG_STRING) {
+                    if (static_cast<size_t>(end - pos) < v) return false;
+                    pos += v;
+                }
+            }
+            return pos == end;
+        }
+        schema = nullptr;
+        if (size < 2) return false;
+        uint16_t fieldCount = 0;
+        memcpy(&fieldCount, in, 2);
+        size_t pos = 2;
+        for (uint16_t i = 0; i < fieldCount; ++i) {
+            if (pos >= size) return false;
+            offsets.push_back(static_cast<uint32_t>(pos));
+            uint8_t tag = in[pos++];
+            if (tag == TYPE_TAG_INT || tag == TYPE_TAG_FLOAT) {
+                pos += 4;
+            } else {
+                if (pos + 2 > size) return false;
+                uint16_t len = 0;
+                memcpy(&len, in + pos, 2);
+                pos += 2 + len;
+            }
+            if (pos > size) return false;
+        }
+        return true;
+    }
+
+    void RecordView::reset(const Record& rec) {
+        record = &rec;
+        single = nullptr;
+        bytes = nullptr;
+        schema = nullptr;
+        offsets.clear();
+    }
+
+    void RecordView::reset(size_t i, const RecordValue& value) {
+        record = nullptr;
+        single = &value;
+        singleIndex = i;
+        bytes = nullptr;
+        schema = nullptr;
+        offsets.clear();
+    }
+
+    size_t RecordView::fieldCount() const {
+        if (record) return record->fields.size();
+        if (single) return singleIndex + 1;
+        return schema ? schema->fieldCount() : offsets.size();
+    }
+
+    uint8_t RecordView::typeTag(size_t i) const {
+        if (i >= fieldCount()) return TYPE_TAG_UNKNOWN;
+        if (record || single) {
+            const RecordValue* v = memoryField(i);
+            return v ? static_cast<uint8_t>(v->index()) : TYPE_TAG_UNKNOWN;
+        }
+        if (schema) return schema->fieldTag(i);
+        uint8_t tag = bytes[offsets[i]];
+        return tag <= TYPE_TAG_STRING ? tag : TYPE_TAG_STRING; // decodeTagged reads other tags as strings
+    }
+
+    int RecordView::getInt(size_t i) const {
+        if (typeTag(i) != TYPE_TAG_INT) return 0;
+        if (record || single) return get<int>(*memoryField(i));
+        if (compact()) {
+            uint32_t v = 0;
+            RecordCodec::readVarint(bytes + offsets[i], bytes + offsets[i] + 5, v);
+            return RecordCodec::unzigzag(v);
+        }
+        int32_t x;
+        memcpy(&x, bytes + fieldStart(i), 4);
+        return x;
+    }
+
+    float RecordView::getFloat(size_t i) const {
+        if (typeTag(i) != TYPE_TAG_FLOAT) return 0.0f;
+        if (record || single) return get<float>(*memoryField(i));
+        float f;
+        memcpy(&f, bytes + fieldStart(i), 4);
+        return f;
+    }
+
+    string_view RecordView::getString(size_t i) const {
+        if (typeTag(i) != TYPE_TAG_STRING) return {};
+        if (record || single) return get<string>(*memoryField(i));
+        if (compact()) {
+            uint32_t len = 0;
+            size_t n = RecordCodec::readVarint(bytes + offsets[i], bytes + offsets[i] + 5, len);
+            return string_view(reinterpret_cast<const char*>(bytes + offsets[i] + n), len);
+        }
+        uint16_t len = 0;
+        memcpy(&len, bytes + offsets[i] + 1, 2);
+        return string_view(reinterpret_cast<const char*>(bytes + offsets[i] + 3), len);
+    }
+
+    optional<int> RecordView::id() const {
+        if (typeTag(0) != TYPE_TAG_INT) return nullopt;
+        return getInt(0);
+    }
+
+    RecordValue RecordView::value(size_t i) const {
+        if (record || single) {
+            const RecordValue* v = memoryField(i);
+            return v ? *v : RecordValue();
+        }
+        switch (typeTag(i)) {
+            case TYPE_TAG_INT: return getInt(i);
+            case TYPE_TAG_FLOAT: return getFloat(i);
+            default: return string(getString(i));
+        }
+    }
+
+    Record RecordView::toRecord() const {
+        if (record) return *record;
+        Record out;
+        size_t n = fieldCount();
+        out.fields.reserve(n);
+        for (size_t i = 0; i < n; ++i) out.fields.push_back(value(i));
+        return out;
+    }
+
+} // namespace ChronoDB
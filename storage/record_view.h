@@ -0,0 +1,70 @@
+#ifndef CHRONODB_RECORD_VIEW_H
+#define CHRONODB_RECORD_VIEW_H
+
+#include <cstdint>
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include "../utils/types.h"
+#include "record_codec.h"
+using namespace std;
+
+namespace ChronoDB {
+
+    // Read-only accessor over one row. Over serialised bytes (a heap slot, a B+Tree
+    // value) parse() walks a TAGGED or COMPACT row once to note where each field
+    // starts (a FIXED row's offsets come from its codec); after that fields are read in
+    // place, strings as string_views into the bytes, so nothing is allocated per
+    // row. It can also wrap an in-memory Record (AVL / BST / HASH tables). Valid
+    // only as long as the bytes, codec or Record it points at.
+    class RecordView {
+    public:
+        RecordView() = default;
+        explicit RecordView(const Record& rec) { reset(rec); }
+
+        // False if the bytes are not a well-formed row of the codec's format
+        bool parse(const RecordCodec& codec, const uint8_t* bytes, size_t size);
+        void reset(const Record& rec);
+        // A view of field i alone (what a filter on one column reads); every
+        // other field reads as missing
+        void reset(size_t i, const RecordValue& value);
+
+        size_t fieldCount() const;
+        // TYPE_TAG_INT / FLOAT / STRING (TYPE_TAG_UNKNOWN past the last field)
+        uint8_t typeTag(size_t i) const;
+        // Typed reads; a field of another type reads as 0 / empty
+        int getInt(size_t i) const;
+        float getFloat(size_t i) const;
+        string_view getString(size_t i) const;
+        // Field 0 when it is an INT (the primary key)
+        optional<int> id() const;
+
+        // Copies out one field / the whole row
+        RecordValue value(size_t i) const;
+        Record toRecord() const;
+
+    private:
+        const Record* record = nullptr;
+        const RecordValue* single = nullptr;  // the one field of a single-field view
+        size_t singleIndex = 0;
+        const uint8_t* bytes = nullptr;
+        const RecordCodec* schema = nullptr; // FIXED / COMPACT rows: field types and layout
+        vector<uint32_t> offsets;            // TAGGED: each field's tag byte; COMPACT: each field
+
+        // The field as an in-memory value (Record and single-field views)
+        const RecordValue* memoryField(size_t i) const {
+            if (record) return &record->fields[i];
+            return i == singleIndex ? single : nullptr;
+        }
+        bool compact() const { return schema && schema->format() == RecordFormat::COMPACT; }
+        // First value byte of a 4-byte field (any INT/FLOAT, except a COMPACT INT)
+        size_t fieldStart(size_t i) const {
+            if (!schema) return offsets[i] + 1;
+            return compact() ? offsets[i] : RecordCodec::fieldOffset(i);
+        }
+    };
+
+} // namespace ChronoDB
+
+#endif // CHRONODB_RECORD_VIEW_H
@@ -5,102 +5,102 @@
 #include <iostream>
 #include <algorithm>
 #include <sstream>
+#include <iterator>
 using namespace std;
 namespace fs = std::filesystem;
 
 namespace ChronoDB {
 
-    // ---------- Page ----------
-    uint16_t Page::freeSpace() const {
-        uint32_t slotDirBytes = static_cast<uint32_t>(slots.size()) * sizeof(SlotEntry);
-        if (usedDataBytes() + slotDirBytes >= PAGE_SIZE) return 0;
-        return static_cast<uint16_t>(PAGE_SIZE - usedDataBytes() - slotDirBytes);
+    // ---------- StorageEngine ----------
+    StorageEngine::StorageEngine(const string& storageDir, size_t bufferPoolBytes)
+        : storageDirectory(storageDir),
+          bufferPool(bufferPoolBytes,
+                     [this](const string& t, uint32_t i, Page& p) { return readPageFromDisk(t, i, p); },
+                     [this](const string& t, uint32_t i, const Page& p) { return writePageToDisk(t, i, p); }) {
+        if (!fs::exists(storageDirectory))
+            fs::create_directories(storageDirectory);
+        // Schemas and structure types of every table, read once; table files
+        // are only opened when a statement first touches them
+        if (!catalog.load(storageDirectory))
+            cerr << "Warning: catalog file in " << storageDirectory << " is damaged" << endl;
+
+        bufferPool.setLogTail([this]() { return wal.nextLSN(); });
+        bufferPool.setPageSizer([this](const string& fileKey) { return pageSizeOf(fileKey); });
+        uint64_t checkpointLSN = 0, lowWaterLSN = 0;
+        readMasterRecord(checkpointLSN, lowWaterLSN);
+        if (wal.open(storageDirectory + "/chronodb.wal", DurabilityMode::GROUP, checkpointLSN)) {
+            recover();
+            if (recoveryStats.bytesReplayed > 0)
+                cout << "[RECOVERY] Replayed " << recoveryStats.bytesReplayed << " log bytes ("
+                     << recoveryStats.recordsReplayed << " records) in " << recoveryStats.milliseconds << " ms" << endl;
+        } else {
+            cerr << "Warning: could not open write-ahead log in " << storageDirectory << endl;
+        }
     }
 
-    optional<uint16_t> Page::insertRawRecord(const vector<uint8_t>& rec) {
-        uint16_t need = static_cast<uint16_t>(rec.size());
-        uint16_t slotOverhead = sizeof(SlotEntry);
-        if (freeSpace() < need + slotOverhead) return nullopt;
-
-        memcpy(data.data() + freeSpaceOffset, rec.data(), need);
-        slots.emplace_back(freeSpaceOffset, need, true);
-        uint16_t slotID = static_cast<uint16_t>(slots.size() - 1);
-        freeSpaceOffset += need;
-        slotCount = static_cast<uint16_t>(slots.size());
-        return slotID;
+    StorageEngine::~StorageEngine() {
+        setAutoVacuum(false);
+        flush();
+        wal.close();
+        readAheads.clear();
+        openFiles.clear();
     }
 
-    bool Page::deleteSlot(uint16_t slotID) {
-        if (slotID >= slots.size() || !slots[slotID].active) return false;
-        slots[slotID].active = false;
-        return true;
+    // Sharp checkpoint: every dirty page is written and synced, so the log can be emptied
+    void StorageEngine::flush() {
+        lock_guard<recursive_mutex> lock(engineMutex);
+        // pages must not get ahead of a log that cannot be written: keep the last checkpoint
+        if (!wal.flushAll()) return;
+        bufferPool.flushAll();
+        for (auto& entry : openFiles) entry.second->sync();
+        markIndexesClean();
+        if (!wal.reset()) cerr << "Warning: could not empty the write-ahead log" << endl;
+        saveFreeSpaceMaps();
+        saveSnapshots();
+        saveCatalogStats();
+        if (!writeMasterRecord(wal.nextLSN(), wal.nextLSN())) return;
+        lastCheckpointLSN = wal.nextLSN();
+        lastCheckpointTime = chrono::steady_clock::now();
     }
 
-    bool Page::readRawRecord(uint16_t slotID, vector<uint8_t>& out) const {
-        if (slotID >= slots.size() || !slots[slotID].active) return false;
-        const SlotEntry& s = slots[slotID];
-        if (s.offset + s.length > PAGE_SIZE) return false;
-        out.resize(s.length);
-        memcpy(out.data(), data.data() + s.offset, s.length);
-        return true;
+    void StorageEngine::setBufferPoolSize(size_t bytes) {
+        lock_guard<recursive_mutex> lock(engineMutex);
+        bufferPool.setMemoryBudget(bytes);
     }
 
-    void Page::serializeToBuffer(vector<uint8_t>& buffer) const {
-        buffer.assign(PAGE_SIZE, 0);
-        memcpy(buffer.data(), &pageID, sizeof(pageID));
-        memcpy(buffer.data() + 8, &slotCount, sizeof(slotCount));
-        memcpy(buffer.data() + 10, &freeSpaceOffset, sizeof(freeSpaceOffset));
-        if (freeSpaceOffset > PAGE_HEADER_RESERVED)
-            memcpy(buffer.data() + PAGE_HEADER_RESERVED, data.data() + PAGE_HEADER_RESERVED, freeSpaceOffset - PAGE_HEADER_RESERVED);
-
-        size_t pos = PAGE_SIZE;
-        for (int i = static_cast<int>(slots.size()) - 1; i >= 0; --i) {
-            const SlotEntry& s = slots[i];
-            pos -= 5;
-            buffer[pos] = s.active ? 1 : 0;
-            memcpy(buffer.data() + pos + 1, &s.length, 2);
-            memcpy(buffer.data() + pos + 3, &s.offset, 2);
+    bool StorageEngine::setDirectIo(bool enabled) {
+        lock_guard<recursive_mutex> lock(engineMutex);
+        directIo = enabled;
+        // reopen what is open already; reads in flight use the old descriptors
+        readAheads.clear();
+        bool allDirect = true;
+        for (auto& entry : openFiles) {
+            entry.second->open(pagedFilePath(entry.first), true, enabled, entry.second->pageSize());
+            allDirect = allDirect && entry.second->isDirect();
         }
+#ifdef _WIN32
+        allDirect = false;
+#endif
+        return !enabled || allDirect;
     }
 
-    void Page::deserializeFromBuffer(const vector<uint8_t>& buffer) {
-        if (buffer.size() < PAGE_SIZE) return;
-        memcpy(&pageID, buffer.data(), sizeof(pageID));
-        memcpy(&slotCount, buffer.data() + 8, sizeof(slotCount));
-        memcpy(&freeSpaceOffset, buffer.data() + 10, sizeof(freeSpaceOffset));
-
-        if (freeSpaceOffset > PAGE_HEADER_RESERVED)
-            memcpy(data.data() + PAGE_HEADER_RESERVED, buffer.data() + PAGE_HEADER_RESERVED, freeSpaceOffset - PAGE_HEADER_RESERVED);
-
-        slots.clear();
-        size_t pos = PAGE_SIZE;
-        for (uint16_t i = 0; i < slotCount; ++i) {
-            if (pos < 5) break;
-            pos -= 5;
-            bool active = buffer[pos] != 0;
-            uint16_t len = 0, off = 0;
-            memcpy(&len, buffer.data() + pos + 1, 2);
-            memcpy(&off, buffer.data() + pos + 3, 2);
-            slots.emplace_back(off, len, active);
-        }
-        reverse(slots.begin(), slots.end());
+    string StorageEngine::tableDataPath(const string& tableName) const {
+        return storageDirectory + "/" + tableName + ".tbl";
     }
 
-    // ---------- StorageEngine ----------
-    StorageEngine::StorageEngine(const string& storageDir) : storageDirectory(storageDir) {
-        if (!fs::exists(storageDirectory))
-            fs::create_directories(storageDirectory);
-        // (In a real system we would load the 'tableStructures' registry from disk here)
+    string StorageEngine::tableFsmPath(const string& tableName) const {
+        return storageDirectory + "/" + tableName + ".fsm";
     }
 
-    StorageEngine::~StorageEngine() {}
-
-    string StorageEngine::tableDataPath(const string& tableName) const {
-        return storageDirectory + "/" + tableName + ".tbl";
+    // Paged files are keyed by table name; other paged files (indexes) by their file name
+    string StorageEngine::pagedFilePath(const string& fileKey) const {
+        if (fileKey.find('.') != string::npos) return storageDirectory + "/" + fileKey;
+        return tableDataPath(fileKey);
     }
 
-    string StorageEngine::tableMetaPath(const string& tableName) const {
-        return storageDirectory + "/" + tableName + ".meta";
+    uint32_t StorageEngine::pageSizeOf(const string& fileKey) const {
+        const TableInfo* info = catalog.find(fileKey.substr(0, fileKey.find('.')));
+        return info ? info->pageSize : DEFAULT_PAGE_SIZE;
     }
 
     // New createTable with columns (writes meta + empty tbl)
@@ -114,460 +114,750 @@ namespace ChronoDB {
         return createTable(tableName, columns, "HEAP");
     }
 
-    bool StorageEngine::createTable(const string& tableName, const vector<Column>& columns, const string& structureType) {
-        // 1. Check if already exists in memory registry
-        if (tableStructures.find(tableName) != tableStructures.end()) return false;
+    bool StorageEngine::createTable(const string& tableName, const vector<Column>& columns, const string& structureType,
+                                    bool compactRows, uint32_t pageSize) {
+        unique_lock<recursive_mutex> lock(engineMutex);
+        // 1. Persist metadata (schema and structure) to disk regardless of structure
+        // This allows us to know columns even if data is in memory.
+        // Fails if the table already exists in the catalog or on disk.
+        StructureType type = Catalog::parseStructure(structureType);
+        if (!catalog.create(tableName, columns, type, compactRows, pageSize)) return false;
 
         // 2. Register type
-        if (structureType == "AVL") {
-            tableStructures[tableName] = StructureType::AVL;
+        if (type == StructureType::AVL) {
             avlTables[tableName] = AVLTree(); 
-        } else if (structureType == "BST") {
-            tableStructures[tableName] = StructureType::BST;
+        } else if (type == StructureType::BST) {
             bstTables[tableName] = BST();
-        } else if (structureType == "HASH") {
-            tableStructures[tableName] = StructureType::HASH;
+        } else if (type == StructureType::HASH) {
             hashTables[tableName] = HashTable();
-        } else {
-            tableStructures[tableName] = StructureType::HEAP;
+        } else if (type == StructureType::COLUMNAR) {
+            // leftover column files would describe some earlier table
+            resetColumnarTable(tableName);
         }
-
-        // 3. Persist metadata (schema) to disk regardless of structure
-        // This allows us to know columns even if data is in memory
-        if (readMetaFile(tableName).has_value()) return false; 
-        
-        // Write meta file (if columns provided)
-        if (!columns.empty()) {
-             if (!writeMetaFile(tableName, columns)) return false;
-        } else {
-             // For legacy empty create
-             vector<Column> cols;
-             writeMetaFile(tableName, cols);
+        if (type == StructureType::AVL || type == StructureType::BST || type == StructureType::HASH ||
+            type == StructureType::COLUMNAR) {
+            // a leftover snapshot would describe some earlier table
+            fs::remove(tableSnapshotPath(tableName));
+            dirtySnapshots.insert(tableName);
         }
+        // a COLUMNAR table gets its empty snapshot at once, so a missing one later
+        // means it was lost rather than that the table is new
+        if (type == StructureType::COLUMNAR && saveSnapshot(tableName)) dirtySnapshots.erase(tableName);
 
-        // 4. If HEAP, create the empty page file
-        if (tableStructures[tableName] == StructureType::HEAP) {
-             string path = tableDataPath(tableName);
-             ofstream file(path, ios::binary);
+        // 3. If HEAP, create the empty page file
+        if (type == StructureType::HEAP) {
+             PagedFile* file = tableFile(tableName, true);
              if (!file) return false;
+             file->truncate(0);
              // Write standard empty page
-             Page p;
-             p.pageID = 0;
-             vector<uint8_t> buffer;
-             p.serializeToBuffer(buffer);
-             file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
-             file.close();
+             Page p(pageSize);
+             p.setPageID(0);
+             PageBuffer buffer(pageSize);
+             p.serializeToBuffer(buffer.data());
+             if (!file->appendPage(buffer.data())) return false;
+
+             freeSpaceMaps[tableName] = make_unique<FreeSpaceMap>(pageSize);
+             freeSpaceMaps[tableName]->update(0, p.freeSpace());
+             freeSpaceMaps[tableName]->save(tableFsmPath(tableName));
+             // a leftover index would describe some earlier heap
+             fs::remove(pagedFilePath(indexFileKey(tableName)));
+        }
+
+        // 4. If BTREE, start the file over and format an empty tree (meta page + root leaf)
+        if (type == StructureType::BTREE) {
+             PagedFile* file = tableFile(tableName, true);
+             if (!file) return false;
+             bufferPool.discardPages(tableName, 0);
+             file->truncate(0);
+             btreeTables.erase(tableName);
+             if (!btreeTable(tableName)) return false;
+             return commitWrite(lock);
         }
 
         return true;
     }
 
-    uint32_t StorageEngine::pageCount(const string& tableName) const {
-        string path = tableDataPath(tableName);
-        if (!fs::exists(path)) return 0;
-        ifstream in(path, ios::binary | ios::ate);
-        streamsize size = in.tellg();
-        in.close();
-        return static_cast<uint32_t>((size + PAGE_SIZE - 1) / PAGE_SIZE);
+    // Handle registry: one descriptor per table file, opened on first use and
+    // kept until the engine shuts down.
+    PagedFile* StorageEngine::tableFile(const string& tableName, bool create) {
+        auto it = openFiles.find(tableName);
+        if (it != openFiles.end()) return it->second.get();
+
+        string path = pagedFilePath(tableName);
+        auto file = make_unique<PagedFile>();
+        if (!file->open(path, create, directIo, pageSizeOf(tableName))) return nullptr;
+        PagedFile* raw = file.get();
+        openFiles[tableName] = move(file);
+        return raw;
     }
 
-    uint32_t StorageEngine::appendEmptyPage(const string& tableName) {
-        string path = tableDataPath(tableName);
-        ofstream out(path, ios::binary | ios::app);
-        Page p;
-        p.pageID = pageCount(tableName);
-        vector<uint8_t> buffer;
-        p.serializeToBuffer(buffer);
-        out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
-        out.close();
-        return p.pageID;
+    uint32_t StorageEngine::pageCount(const string& tableName) {
+        PagedFile* file = tableFile(tableName);
+        return file ? file->pageCount() : 0;
     }
 
+    optional<uint32_t> StorageEngine::appendEmptyPage(const string& tableName) {
+        PagedFile* file = tableFile(tableName, true);
+        if (!file) return nullopt;
+        Page p(file->pageSize());
+        p.setPageID(file->pageCount());
+        PageBuffer buffer(file->pageSize());
+        p.serializeToBuffer(buffer.data());
+        optional<uint32_t> index = file->appendPage(buffer.data());
+        if (!index.has_value()) return nullopt;
+
+        auto it = freeSpaceMaps.find(tableName);
+        if (it != freeSpaceMaps.end()) it->second->update(*index, p.freeSpace());
+        return index;
+    }
+
+    // The table's free-space map, loaded from its .fsm file on first use. Pages the
+    // file does not cover (missing map, or pages added after it was last saved)
+    // are measured once through the buffer pool.
+    FreeSpaceMap* StorageEngine::freeSpaceMap(const string& tableName) {
+        auto it = freeSpaceMaps.find(tableName);
+        if (it != freeSpaceMaps.end()) return it->second.get();
+
+        auto fsm = make_unique<FreeSpaceMap>(pageSizeOf(tableName));
+        fsm->load(tableFsmPath(tableName));
+        uint32_t pages = pageCount(tableName);
+        uint32_t known = min(fsm->pageCount(), pages);
+        fsm->resize(pages);
+        for (uint32_t i = known; i < pages; ++i) {
+            PageHandle p(bufferPool, tableName, i);
+            if (p.valid()) fsm->update(i, p->freeSpace());
+        }
+        FreeSpaceMap* raw = fsm.get();
+        freeSpaceMaps[tableName] = move(fsm);
+        return raw;
+    }
+
+    void StorageEngine::saveFreeSpaceMaps() {
+        for (auto& entry : freeSpaceMaps)
+            if (entry.second->isDirty()) entry.second->save(tableFsmPath(entry.first));
+    }
+
+    // Page access for callers outside the engine goes through the buffer pool;
+    // the page is copied in/out of its frame and written back lazily.
     bool StorageEngine::writePageToFile(const string& tableName, uint32_t pageIndex, const Page& page) {
-        fstream fsout(tableDataPath(tableName), ios::binary | ios::in | ios::out);
-        if (!fsout) { fsout.open(tableDataPath(tableName), ios::binary | ios::out); fsout.close(); fsout.open(tableDataPath(tableName), ios::binary | ios::in | ios::out); }
-        vector<uint8_t> buffer;
-        page.serializeToBuffer(buffer);
-        fsout.seekp(static_cast<streampos>(pageIndex) * PAGE_SIZE);
-        fsout.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
-        fsout.flush(); fsout.close();
+        lock_guard<recursive_mutex> lock(engineMutex);
+        PageHandle h(bufferPool, tableName, pageIndex, true);
+        if (!h.valid() || h->size() != page.size()) return false;
+        *h = page;
+        h.markDirty();
         return true;
     }
 
     bool StorageEngine::readPageFromFile(const string& tableName, uint32_t pageIndex, Page& outPage) {
-        ifstream infile(tableDataPath(tableName), ios::binary);
-        infile.seekg(static_cast<streampos>(pageIndex) * PAGE_SIZE);
-        vector<uint8_t> buffer(PAGE_SIZE);
-        infile.read(reinterpret_cast<char*>(buffer.data()), PAGE_SIZE);
-        infile.close();
-        outPage.deserializeFromBuffer(buffer);
+        lock_guard<recursive_mutex> lock(engineMutex);
+        PageHandle h(bufferPool, tableName, pageIndex);
+        if (!h.valid()) return false;
+        outPage = *h;
         return true;
     }
 
-    // record serialisation (unchanged)
-    void StorageEngine::serializeRecord(const Record& r, vector<uint8_t>& out) {
-        out.clear();
-        uint16_t fieldCount = static_cast<uint16_t>(r.fields.size());
-        out.resize(2); memcpy(out.data(), &fieldCount, 2);
-
-        for (const RecordValue& v : r.fields) {
-            uint8_t typeTag = 0;
-            if (holds_alternative<int>(v)) typeTag = 0;
-            else if (holds_alternative<float>(v)) typeTag = 1;
-            else typeTag = 2;
-
-            size_t prev = out.size(); out.resize(prev + 1); out[prev] = typeTag;
-
-            if (typeTag == 0) {
-                int32_t x = get<int>(v);
-                size_t cur = out.size(); out.resize(cur + sizeof(int32_t));
-                memcpy(out.data() + cur, &x, sizeof(int32_t));
-            } else if (typeTag == 1) {
-                float f = get<float>(v);
-                size_t cur = out.size(); out.resize(cur + sizeof(float));
-                memcpy(out.data() + cur, &f, sizeof(float));
-            } else {
-                const string& s = get<string>(v);
-                uint16_t len = static_cast<uint16_t>(s.size());
-                size_t cur = out.size(); out.resize(cur + 2 + len);
-                memcpy(out.data() + cur, &len, 2);
-                memcpy(out.data() + cur + 2, s.data(), len);
-            }
-        }
+    bool StorageEngine::writePageToDisk(const string& tableName, uint32_t pageIndex, const Page& page) {
+        // WAL rule: the log must reach disk before the page that depends on it
+        if (page.pageLSN() != 0 && !wal.flushTo(page.pageLSN())) return false;
+        PagedFile* file = tableFile(tableName, true);
+        if (!file) return false;
+        // the page is its own aligned image
+        return file->writePage(pageIndex, page.data.data());
     }
 
-    bool StorageEngine::deserializeRecord(const vector<uint8_t>& in, Record& out) {
-        out.fields.clear();
-        if (in.size() < 2) return false;
-        uint16_t fieldCount = 0; memcpy(&fieldCount, in.data(), 2);
-        size_t pos = 2;
-
-        for (uint16_t i = 0; i < fieldCount; ++i) {
-            if (pos >= in.size()) return false;
-            uint8_t typeTag = in[pos]; pos += 1;
-            if (typeTag == 0) {
-                if (pos + 4 > in.size()) return false;
-                int32_t x; memcpy(&x, in.data() + pos, 4); pos += 4;
-                out.fields.emplace_back(x);
-            } else if (typeTag == 1) {
-                if (pos + 4 > in.size()) return false;
-                float f; memcpy(&f, in.data() + pos, 4); pos += 4;
-                out.fields.emplace_back(f);
-            } else {
-                if (pos + 2 > in.size()) return false;
-                uint16_t len = 0; memcpy(&len, in.data() + pos, 2); pos += 2;
-                if (pos + len > in.size()) return false;
-                string s(reinterpret_cast<const char*>(in.data() + pos), len);
-                pos += len;
-                out.fields.emplace_back(s);
-            }
+    bool StorageEngine::readPageFromDisk(const string& tableName, uint32_t pageIndex, Page& outPage) {
+        PagedFile* file = tableFile(tableName);
+        if (!file) return false;
+        // a miss during a scan is usually served by pages read ahead of it
+        auto ahead = readAheads.find(tableName);
+        const uint8_t* prefetched = ahead != readAheads.end() ? ahead->second->page(pageIndex) : nullptr;
+        if (prefetched) {
+            outPage.deserializeFromBuffer(prefetched);
+            return true;
         }
+        if (!file->readPage(pageIndex, outPage.data.data())) return false;
+        outPage.checkHeader();
         return true;
     }
 
-    // helper: check a schema type string matches a RecordValue
-    bool StorageEngine::typeStringMatchesValue(const string& typeStr, const RecordValue& v) {
-        string t = typeStr;
-        transform(t.begin(), t.end(), t.begin(), ::toupper);
-        if (t == "INT") return holds_alternative<int>(v);
-        if (t == "FLOAT") return holds_alternative<float>(v);
-        if (t == "STRING") return holds_alternative<string>(v);
+    // ---------- Write-ahead logging ----------
+    uint64_t StorageEngine::logHeapOp(LogType type, const string& tableName, uint32_t pageIndex, uint16_t slotID,
+                                      const uint8_t* bytes, size_t len) {
+        LogRecord rec;
+        rec.type = type;
+        rec.table = tableName;
+        rec.pageIndex = pageIndex;
+        rec.slotID = slotID;
+        if (bytes) rec.payload.assign(bytes, bytes + len);
+        lastWriteLSN = wal.append(rec);
+        return lastWriteLSN;
+    }
+
+    // End of a modifying statement: wait for durability per the log's mode. The
+    // engine lock is released for the wait, so statements arriving meanwhile can
+    // log their records and share the same group commit.
+    bool StorageEngine::commitWrite(unique_lock<recursive_mutex>& lock) {
+        uint64_t lsn = lastWriteLSN;
+        if (wal.nextLSN() - lastCheckpointLSN > CHECKPOINT_LOG_BYTES ||
+            chrono::steady_clock::now() - lastCheckpointTime > CHECKPOINT_INTERVAL)
+            checkpoint();
+        lock.unlock();
+        return wal.commit(lsn);
+    }
+
+    void StorageEngine::setDurabilityMode(DurabilityMode mode) {
+        wal.setDurabilityMode(mode);
+    }
+
+    DurabilityMode StorageEngine::getDurabilityMode() const {
+        return wal.durabilityMode();
+    }
+
+    // Fuzzy checkpoint. Pages are not all forced out: only those dirtied before the
+    // previous checkpoint are written, so a hot page is flushed at most once per
+    // interval. The dirty page table goes into a CHECKPOINT record, and the oldest
+    // recLSN in it (the low-water mark) is where recovery has to start; the log
+    // below it is dropped.
+    void StorageEngine::checkpoint() {
+        bufferPool.flushOlderThan(lastCheckpointLSN);
+        for (auto& entry : openFiles) entry.second->sync();
+        saveFreeSpaceMaps();
+        saveSnapshots();
+        saveCatalogStats();
+
+        auto dpt = bufferPool.dirtyPageTable();
+        LogRecord rec;
+        rec.type = LogType::CHECKPOINT;
+        uint32_t count = static_cast<uint32_t>(dpt.size());
+        rec.payload.resize(sizeof(count));
+        memcpy(rec.payload.data(), &count, sizeof(count));
+        for (const auto& entry : dpt) {
+            uint16_t nameLen = static_cast<uint16_t>(entry.first.table.size());
+            size_t pos = rec.payload.size();
+            rec.payload.resize(pos + 2 + nameLen + 4 + 8);
+            memcpy(rec.payload.data() + pos, &nameLen, 2);
+            memcpy(rec.payload.data() + pos + 2, entry.first.table.data(), nameLen);
+            memcpy(rec.payload.data() + pos + 2 + nameLen, &entry.first.pageIndex, 4);
+            memcpy(rec.payload.data() + pos + 6 + nameLen, &entry.second, 8);
+        }
+
+        uint64_t checkpointLSN = wal.append(rec);
+        if (!wal.flushTo(checkpointLSN)) return;
+
+        uint64_t lowWater = checkpointLSN;
+        for (const auto& entry : dpt) lowWater = min(lowWater, entry.second);
+        // without its master record the checkpoint does not count: recovery still
+        // starts at the previous one, so the log it needs is kept
+        if (!writeMasterRecord(checkpointLSN, lowWater)) return;
+        wal.truncateBefore(lowWater);
+
+        lastCheckpointLSN = checkpointLSN;
+        lastCheckpointTime = chrono::steady_clock::now();
+    }
+
+    // Master record: where the last checkpoint is and where recovery must start.
+    // Swapped in with replaceFile so it is never half-written and survives a crash.
+    bool StorageEngine::writeMasterRecord(uint64_t checkpointLSN, uint64_t lowWaterLSN) {
+        vector<uint8_t> bytes(sizeof(checkpointLSN) + sizeof(lowWaterLSN));
+        memcpy(bytes.data(), &checkpointLSN, sizeof(checkpointLSN));
+        memcpy(bytes.data() + sizeof(checkpointLSN), &lowWaterLSN, sizeof(lowWaterLSN));
+        if (replaceFile(storageDirectory + "/chronodb.ckpt", bytes)) return true;
+        cerr << "Error: could not write the checkpoint record in " << storageDirectory << endl;
         return false;
     }
 
-    bool StorageEngine::insertRecord(const string& tableName, const Record& rec) {
-        if (tableStructures.find(tableName) == tableStructures.end()) {
-             // Try to load from disk if not in memory (legacy support)
-             if (readMetaFile(tableName).has_value()) {
-                 tableStructures[tableName] = StructureType::HEAP;
-             } else {
-                 return false;
-             }
+    bool StorageEngine::readMasterRecord(uint64_t& checkpointLSN, uint64_t& lowWaterLSN) const {
+        checkpointLSN = lowWaterLSN = 0;
+        ifstream in(storageDirectory + "/chronodb.ckpt", ios::binary);
+        uint64_t ckpt = 0, lowWater = 0;
+        if (!in.read(reinterpret_cast<char*>(&ckpt), sizeof(ckpt))) return false;
+        if (!in.read(reinterpret_cast<char*>(&lowWater), sizeof(lowWater))) return false;
+        checkpointLSN = ckpt;
+        lowWaterLSN = lowWater;
+        return true;
+    }
+
+    // Single sequential redo pass over the log tail that starts at the low-water
+    // mark of the last checkpoint. Page LSNs make replay idempotent: a record is
+    // applied only if the page on disk has not seen it yet.
+    void StorageEngine::recover() {
+        auto start = chrono::steady_clock::now();
+        recoveryStats = RecoveryStats();
+        uint64_t checkpointLSN = 0;
+        readMasterRecord(checkpointLSN, recoveryStats.startLSN);
+        recoveryStats.bytesReplayed = wal.scan(recoveryStats.startLSN, [&](const LogRecord& rec) {
+            redo(rec);
+            recoveryStats.recordsReplayed++;
+        });
+        flush();
+        recoveryStats.milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+
+    void StorageEngine::redo(const LogRecord& rec) {
+        if (rec.type == LogType::CHECKPOINT) return;
+        if (rec.type == LogType::BTREE_IMAGES) {
+            redoTreeImages(rec);
+            return;
+        }
+        if (rec.type == LogType::TABLE_TRUNCATE) {
+            bufferPool.discardPages(rec.table, rec.pageIndex);
+            if (PagedFile* file = tableFile(rec.table, true)) file->truncate(rec.pageIndex);
+            auto it = freeSpaceMaps.find(rec.table);
+            if (it != freeSpaceMaps.end()) it->second->resize(rec.pageIndex);
+            return;
         }
 
-        switch (tableStructures[tableName]) {
+        PagedFile* file = tableFile(rec.table, true);
+        if (!file) return;
+        while (file->pageCount() <= rec.pageIndex)
+            if (!appendEmptyPage(rec.table)) return;
+
+        PageHandle p(bufferPool, rec.table, rec.pageIndex);
+        if (!p.valid() || p->pageLSN() >= rec.lsn) return;
+
+        switch (rec.type) {
+            case LogType::HEAP_INSERT:
+                p->insertRawRecord(rec.payload);
+                break;
+            case LogType::HEAP_DELETE:
+                p->deleteSlot(rec.slotID);
+                break;
+            case LogType::HEAP_UPDATE:
+                p->replaceRecord(rec.slotID, rec.payload);
+                break;
+            case LogType::HEAP_MOVE_IN:
+                p->insertRawRecord(rec.payload, SLOT_MOVED);
+                break;
+            case LogType::HEAP_FORWARD: {
+                if (rec.payload.size() < FORWARD_BYTES) return;
+                RecordLocation target;
+                memcpy(&target.pageIndex, rec.payload.data(), 4);
+                memcpy(&target.slotID, rec.payload.data() + 4, 2);
+                p->setForward(rec.slotID, target);
+                break;
+            }
+            case LogType::PAGE_IMAGE:
+                p->deserializeFromBuffer(rec.payload);
+                break;
+            case LogType::BTREE_PUT:
+            case LogType::BTREE_REMOVE: {
+                if (rec.payload.size() < 4) return;
+                int32_t key = 0;
+                memcpy(&key, rec.payload.data(), 4);
+                if (rec.type == LogType::BTREE_PUT)
+                    BPlusTree::leafPut(*p, key, vector<uint8_t>(rec.payload.begin() + 4, rec.payload.end()));
+                else
+                    BPlusTree::leafRemove(*p, key);
+                p->setPageLSN(rec.lsn);
+                p.markDirty();
+                return; // tree pages have no free-space map
+            }
+            default:
+                return;
+        }
+        p->setPageLSN(rec.lsn);
+        p.markDirty();
+        freeSpaceMap(rec.table)->update(rec.pageIndex, p->freeSpace());
+    }
+
+    bool StorageEngine::insertRecord(const string& tableName, const Record& rec) {
+        unique_lock<recursive_mutex> lock(engineMutex);
+        const TableInfo* table = openTable(tableName);
+        if (!table) return false;
+
+        switch (table->structure) {
             case StructureType::AVL:
                 avlTables[tableName].insert(rec);
+                dirtySnapshots.insert(tableName);
                 return true;
             case StructureType::BST:
                 bstTables[tableName].insert(rec);
+                dirtySnapshots.insert(tableName);
                 return true;
             case StructureType::HASH:
                 hashTables[tableName].insert(rec);
+                dirtySnapshots.insert(tableName);
                 return true;
+            case StructureType::BTREE:
+                if (!insertTreeRecord(tableName, rec)) return false;
+                return commitWrite(lock);
+            case StructureType::COLUMNAR:
+                return insertColumnarRecord(tableName, rec);
             case StructureType::HEAP:
             default:
                 // Original Heap Logic
                 // validate schema matches
-                auto colsOpt = readMetaFile(tableName);
-                if (!colsOpt.has_value()) return false;
-                vector<Column> cols = colsOpt.value();
-
-                if (cols.empty()) {
-                    // fallback: accept any (legacy)
-                } else {
-                    if (rec.fields.size() != cols.size()) return false;
-                    // require first column is int (primary key)
-                    if (!holds_alternative<int>(rec.fields[0])) return false;
-                    // types match
-                    for (size_t i = 0; i < cols.size(); ++i) {
-                        if (!typeStringMatchesValue(cols[i].type, rec.fields[i])) return false;
-                    }
-                }
-
-                // load all records, remove existing with same id (upsert behaviour)
-                vector<Record> records = loadAllRecords(tableName);
-                if (rec.fields.size() > 0 && holds_alternative<int>(rec.fields[0])) {
-                    int id = get<int>(rec.fields[0]);
-                    records.erase(
-                        remove_if(records.begin(), records.end(),
-                            [&](const Record& r){ return get<int>(r.fields[0]) == id; }),
-                        records.end()
-                    );
-                }
-
-                records.push_back(rec);
-
-                // write all records back (pack into pages)
-                ofstream out(tableDataPath(tableName), ios::binary | ios::trunc);
-                if (!out) return false;
-
-                Page p;
-                p.pageID = 0;
-                for (const auto& r : records) {
-                    vector<uint8_t> bytes;
-                    serializeRecord(r, bytes);
-                    auto optSlot = p.insertRawRecord(bytes);
-                    if (!optSlot.has_value()) {
-                        vector<uint8_t> buffer; p.serializeToBuffer(buffer);
-                        out.write((char*)buffer.data(), buffer.size());
-                        p = Page(); p.pageID++;
-                        p.insertRawRecord(bytes);
-                    }
-                }
-                vector<uint8_t> buffer; p.serializeToBuffer(buffer);
-                out.write((char*)buffer.data(), buffer.size());
-                out.close();
-                return true;
+                if (!table->matches(rec)) return false;
+                // require first column is int (primary key)
+                if (!table->columns.empty() && !holds_alternative<int>(rec.fields[0])) return false;
+
+                vector<uint8_t> bytes;
+                if (!table->codec.encode(rec, bytes)) return false;
+                if (bytes.size() + SLOT_ENTRY_BYTES > table->pageSize - PAGE_HEADER_RESERVED) return false;
+                if (!insertHeapRow(tableName, bytes)) return false;
+                return commitWrite(lock);
         }
     }
 
-    bool StorageEngine::updateRecord(const string& tableName, int id, const Record& newRecord) {
-        auto colsOpt = readMetaFile(tableName);
-        if (!colsOpt.has_value()) return false;
-        vector<Column> cols = colsOpt.value();
-
-        if (!cols.empty()) {
-            if (newRecord.fields.size() != cols.size()) return false;
-            // types match
-            for (size_t i = 0; i < cols.size(); ++i) {
-                if (!typeStringMatchesValue(cols[i].type, newRecord.fields[i])) return false;
-            }
+    bool StorageEngine::insertHeapRow(const string& tableName, const vector<uint8_t>& bytes) {
+        // the index goes unclean before the heap changes it will have to describe
+        primaryIndexForWrite(tableName);
+
+        // upsert behaviour: tombstone an existing row with the same id in place
+        const RecordCodec& codec = codecFor(tableName);
+        int id = 0;
+        bool hasId = codec.peekId(bytes.data(), bytes.size(), id);
+        if (hasId) {
+            auto loc = locateRecord(tableName, id);
+            if (loc.has_value() && !removeRecordAt(tableName, *loc)) return false;
         }
-
-        vector<Record> records = loadAllRecords(tableName);
-        bool updated = false;
-        for (auto& r : records) {
-            if (get<int>(r.fields[0]) == id) { r = newRecord; updated = true; break; }
-        }
-        if (!updated) return false;
-
-        // write back
-        ofstream out(tableDataPath(tableName), ios::binary | ios::trunc);
-        if (!out) return false;
-
-        Page p;
-        p.pageID = 0;
-        for (const auto& rec : records) {
-            vector<uint8_t> bytes;
-            serializeRecord(rec, bytes);
-            auto optSlot = p.insertRawRecord(bytes);
-            if (!optSlot.has_value()) {
-                vector<uint8_t> buffer; p.serializeToBuffer(buffer);
-                out.write((char*)buffer.data(), buffer.size());
-                p = Page();
-                p.pageID++;
-                p.insertRawRecord(bytes);
-            }
-        }
-        vector<uint8_t> buffer; p.serializeToBuffer(buffer);
-        out.write((char*)buffer.data(), buffer.size());
-        out.close();
+        optional<RecordLocation> loc = placeRecord(tableName, bytes, SLOT_LIVE);
+        if (!loc.has_value()) return false;
+        if (hasId) indexPut(tableName, id, *loc);
         return true;
     }
 
-    bool StorageEngine::deleteRecord(const string& tableName, int id) {
-        vector<Record> records = loadAllRecords(tableName);
-
-        size_t before = records.size();
-
-        records.erase(
-            remove_if(records.begin(), records.end(),
-                [&](const Record& r) { return get<int>(r.fields[0]) == id; }),
-            records.end()
-        );
-
-        if (records.size() == before) return false;  // not found
-
-        ofstream out(tableDataPath(tableName), ios::binary | ios::trunc);
-        if (!out) return false;
-
-        Page p;
-        p.pageID = 0;
-        for (const auto& rec : records) {
-            vector<uint8_t> bytes;
-            serializeRecord(rec, bytes);
-            auto optSlot = p.insertRawRecord(bytes);
-            if (!optSlot.has_value()) {
-                vector<uint8_t> buffer; p.serializeToBuffer(buffer);
-                out.write((char*)buffer.data(), buffer.size());
-                p = Page(); p.pageID++;
-                p.insertRawRecord(bytes);
+    size_t StorageEngine::insertRecords(const string& tableName, const vector<Record>& rows) {
+        unique_lock<recursive_mutex> lock(engineMutex);
+        const TableInfo* table = openTable(tableName);
+        if (!table) return 0;
+        StructureType type = table->structure;
+
+        // 1. the whole batch is checked (and HEAP / BTREE rows encoded) before anything changes
+        bool paged = type == StructureType::HEAP || type == StructureType::BTREE;
+        size_t maxBytes = type == StructureType::BTREE ? BPlusTree::maxValueBytes(table->pageSize)
+                                                       : table->pageSize - PAGE_HEADER_RESERVED - SLOT_ENTRY_BYTES;
+        vector<vector<uint8_t>> encoded(paged ? rows.size() : 0);
+        for (size_t i = 0; i < rows.size(); ++i) {
+            const Record& rec = rows[i];
+            if (!table->matches(rec)) return 0;
+            if (!table->columns.empty() && !holds_alternative<int>(rec.fields[0])) return 0;
+            if (type == StructureType::COLUMNAR) {
+                for (const RecordValue& v : rec.fields)
+                    if (!ColumnSegment::fits(v, table->pageSize)) return 0;
             }
+            if (paged && (!table->codec.encode(rec, encoded[i]) || encoded[i].size() > maxBytes)) return 0;
         }
-        vector<uint8_t> buffer; p.serializeToBuffer(buffer);
-        out.write((char*)buffer.data(), buffer.size());
-        out.close();
 
-        return true;
-    }
-
-    vector<Record> StorageEngine::selectAll(const string& tableName) {
-        if (tableStructures.find(tableName) == tableStructures.end()) {
-             if (readMetaFile(tableName).has_value()) tableStructures[tableName] = StructureType::HEAP;
-             else return {};
+        // 2. stored in order until one fails, one commit at the end
+        size_t stored = 0;
+        switch (type) {
+            case StructureType::AVL:
+                for (const Record& rec : rows) avlTables[tableName].insert(rec);
+                dirtySnapshots.insert(tableName);
+                return rows.size();
+            case StructureType::BST:
+                for (const Record& rec : rows) bstTables[tableName].insert(rec);
+                dirtySnapshots.insert(tableName);
+                return rows.size();
+            case StructureType::HASH:
+                for (const Record& rec : rows) hashTables[tableName].insert(rec);
+                dirtySnapshots.insert(tableName);
+                return rows.size();
+            case StructureType::COLUMNAR:
+                while (stored < rows.size() && insertColumnarRecord(tableName, rows[stored])) stored++;
+                return stored;
+            case StructureType::BTREE: {
+                BPlusTree* tree = btreeTable(tableName);
+                if (!tree) return 0;
+                while (stored < rows.size() && tree->put(get<int>(rows[stored].fields[0]), encoded[stored])) stored++;
+                break;
+            }
+            case StructureType::HEAP:
+            default:
+                if (table->columns.empty()) {
+                    // rows without a schema need not have an id to pack them by
+                    while (stored < rows.size() && insertHeapRow(tableName, encoded[stored])) stored++;
+                    break;
+                }
+                {
+                    vector<pair<int32_t, vector<uint8_t>>> batch;
+                    batch.reserve(rows.size());
+                    for (size_t i = 0; i < rows.size(); ++i)
+                        batch.emplace_back(get<int>(rows[i].fields[0]), move(encoded[i]));
+                    stored = bulkLoadHeap(tableName, batch);
+                }
+                break;
         }
+        if (stored == 0) return 0;
+        return commitWrite(lock) ? stored : 0;
+    }
 
-        switch (tableStructures[tableName]) {
+    optional<Record> StorageEngine::findRecord(const string& tableName, int id) {
+        lock_guard<recursive_mutex> lock(engineMutex);
+        const TableInfo* table = openTable(tableName);
+        if (!table) return nullopt;
+        switch (table->structure) {
             case StructureType::AVL:
-                return avlTables[tableName].getAllSorted();
+                return avlTables[tableName].search(id);
             case StructureType::BST:
-                return bstTables[tableName].getAllSorted();
+                return bstTables[tableName].search(id);
             case StructureType::HASH:
-                return hashTables[tableName].getAll();
+                return hashTables[tableName].search(id);
+            case StructureType::BTREE:
+                return findTreeRecord(tableName, id);
+            case StructureType::COLUMNAR:
+                return findColumnarRecord(tableName, id);
             case StructureType::HEAP:
             default:
-                vector<Record> outRecords;
-                uint32_t pages = pageCount(tableName);
-                for (uint32_t i = 0; i < pages; ++i) {
-                    Page p; readPageFromFile(tableName, i, p);
-                    for (uint16_t s = 0; s < p.slots.size(); ++s) {
-                        if (!p.slots[s].active) continue;
-                        vector<uint8_t> raw; p.readRawRecord(s, raw);
-                        Record rec; if (deserializeRecord(raw, rec)) outRecords.push_back(move(rec));
-                    }
-                }
-                return outRecords;
+                break;
         }
+        optional<RecordLocation> loc = locateRecord(tableName, id);
+        if (!loc.has_value()) return nullopt;
+        PageHandle p(bufferPool, tableName, loc->pageIndex);
+        if (!p.valid()) return nullopt;
+        SlotEntry e = p->slot(loc->slotID);
+        Record rec;
+        if (!codecFor(tableName).decode(p->data.data() + e.recordOffset(), e.recordLength(), rec)) return nullopt;
+        return rec;
     }
 
-    // Helper method to load all records from a table (used by update/delete to avoid redundancy)
-    vector<Record> StorageEngine::loadAllRecords(const string& tableName) const {
-        vector<Record> records;
-        string path = tableDataPath(tableName);
+    bool StorageEngine::updateRecord(const string& tableName, int id, const Record& newRecord) {
+        unique_lock<recursive_mutex> lock(engineMutex);
+        const TableInfo* table = openTable(tableName);
+        if (!table || !table->matches(newRecord)) return false;
+        if (table->structure == StructureType::BTREE)
+            return updateTreeRecord(tableName, id, newRecord) && commitWrite(lock);
+        if (table->structure == StructureType::COLUMNAR) return updateColumnarRecord(tableName, id, newRecord);
+
+        auto loc = locateRecord(tableName, id);
+        if (!loc.has_value()) return false;
+
+        vector<uint8_t> bytes;
+        if (!table->codec.encode(newRecord, bytes)) return false;
+        if (bytes.size() + FORWARD_BYTES + SLOT_ENTRY_BYTES > table->pageSize - PAGE_HEADER_RESERVED) return false;
+        // a new primary key must not be another row's
+        int newId = 0;
+        if (table->codec.peekId(bytes.data(), bytes.size(), newId) && newId != id && locateRecord(tableName, newId))
+            return false;
+        primaryIndexForWrite(tableName);
+        if (!replaceRecordAt(tableName, *loc, bytes)) return false;
+        return commitWrite(lock);
+    }
 
-        ifstream in(path, ios::binary);
-        if (!in) return records;
+    bool StorageEngine::deleteRecord(const string& tableName, int id) {
+        unique_lock<recursive_mutex> lock(engineMutex);
+        StructureType type = getStructureType(tableName);
+        if (type == StructureType::BTREE) return deleteTreeRecord(tableName, id) && commitWrite(lock);
+        if (type == StructureType::COLUMNAR) return openTable(tableName) && deleteColumnarRecord(tableName, id);
+        auto loc = locateRecord(tableName, id);
+        if (!loc.has_value()) return false;  // not found
+        if (!removeRecordAt(tableName, *loc)) return false;
+        return commitWrite(lock);
+    }
 
-        while (true) {
-            vector<uint8_t> buffer(PAGE_SIZE);
-            if (!in.read((char*)buffer.data(), buffer.size())) break;
+    // Stores raw slot bytes in the first page the free-space map says has room,
+    // appending a page when none has. Returns where the record landed.
+    optional<RecordLocation> StorageEngine::placeRecord(const string& tableName, const vector<uint8_t>& raw, uint8_t state,
+                                                        uint32_t pageLimit) {
+        FreeSpaceMap* fsm = freeSpaceMap(tableName);
+        uint32_t needed = static_cast<uint32_t>(raw.size() + SLOT_ENTRY_BYTES);
+        LogType type = state == SLOT_MOVED ? LogType::HEAP_MOVE_IN : LogType::HEAP_INSERT;
+        for (;;) {
+            optional<uint32_t> candidate = fsm->findPage(needed);
+            if (candidate.has_value() && *candidate >= pageLimit) return nullopt;
+            if (!candidate.has_value() && pageLimit != UINT32_MAX) return nullopt;
+            optional<uint32_t> target = candidate.has_value() ? candidate : appendEmptyPage(tableName);
+            if (!target.has_value()) return nullopt;
+            PageHandle p(bufferPool, tableName, *target);
+            if (!p.valid()) return nullopt;
+            optional<uint16_t> slot = p->insertRawRecord(raw, state);
+            fsm->update(*target, p->freeSpace());
+            if (slot.has_value()) {
+                p->setPageLSN(logHeapOp(type, tableName, *target, *slot, raw.data(), raw.size()));
+                p.markDirty();
+                return RecordLocation{*target, *slot};
+            }
+            if (!candidate.has_value()) return nullopt; // does not fit an empty page
+            // the map was stale for this page; it is corrected now, try again
+        }
+    }
 
-            Page p;
-            p.deserializeFromBuffer(buffer);
+    // Deletes the record at loc; a relocated record also takes its forwarding stub with it
+    bool StorageEngine::removeRecordAt(const string& tableName, const RecordLocation& loc) {
+        optional<RecordLocation> home;
+        {
+            PageHandle p(bufferPool, tableName, loc.pageIndex);
+            if (!p.valid() || loc.slotID >= p->slotCount()) return false;
+            SlotEntry e = p->slot(loc.slotID);
+            int id = 0;
+            if (e.holdsRecord() && codecFor(tableName).peekId(p->data.data() + e.recordOffset(), e.recordLength(), id))
+                indexRemove(tableName, id);
+            if (e.state == SLOT_MOVED) home = p->linkedLocation(loc.slotID);
+            deadBytesSinceVacuum[tableName] += p->slot(loc.slotID).length;
+            if (!p->deleteSlot(loc.slotID)) return false;
+            p->setPageLSN(logHeapOp(LogType::HEAP_DELETE, tableName, loc.pageIndex, loc.slotID, nullptr, 0));
+            p.markDirty();
+        }
+        if (home.has_value()) {
+            PageHandle h(bufferPool, tableName, home->pageIndex);
+            if (!h.valid()) return false;
+            if (h->deleteSlot(home->slotID)) {
+                deadBytesSinceVacuum[tableName] += FORWARD_BYTES;
+                h->setPageLSN(logHeapOp(LogType::HEAP_DELETE, tableName, home->pageIndex, home->slotID, nullptr, 0));
+                h.markDirty();
+            }
+        }
+        return true;
+    }
 
-            if (p.slotCount == 0) break;
+    // Replaces the record at loc with new encoded bytes. Stays in the same slot when
+    // the page has room (in place if it is no longer than before); otherwise the
+    // record moves to another page and its home slot becomes a forwarding stub, so
+    // its record ID never changes and there is never more than one hop.
+    bool StorageEngine::replaceRecordAt(const string& tableName, const RecordLocation& loc, const vector<uint8_t>& bytes) {
+        PageHandle p(bufferPool, tableName, loc.pageIndex);
+        if (!p.valid() || loc.slotID >= p->slotCount()) return false;
+        SlotEntry e = p->slot(loc.slotID);
+        if (!e.holdsRecord()) return false;
+
+        RecordLocation home = loc;
+        if (e.state == SLOT_MOVED) {
+            auto link = p->linkedLocation(loc.slotID);
+            if (!link.has_value()) return false;
+            home = *link;
+        }
+        // a changed primary key moves the index entry (the home stays the same)
+        int oldId = 0, newId = 0;
+        const RecordCodec& codec = codecFor(tableName);
+        bool rekey = codec.peekId(p->data.data() + e.recordOffset(), e.recordLength(), oldId) &&
+                     codec.peekId(bytes.data(), bytes.size(), newId) && oldId != newId;
+        auto reindex = [&]() {
+            if (!rekey) return true;
+            indexRemove(tableName, oldId);
+            indexPut(tableName, newId, home);
+            return true;
+        };
+        auto withHome = [&](const vector<uint8_t>& rec) {
+            vector<uint8_t> raw(FORWARD_BYTES + rec.size());
+            memcpy(raw.data(), &home.pageIndex, 4);
+            memcpy(raw.data() + 4, &home.slotID, 2);
+            memcpy(raw.data() + FORWARD_BYTES, rec.data(), rec.size());
+            return raw;
+        };
+
+        // 1. same slot
+        uint16_t oldOffset = e.offset, oldLength = e.length;
+        vector<uint8_t> raw = e.state == SLOT_MOVED ? withHome(bytes) : bytes;
+        if (p->replaceRecord(loc.slotID, raw)) {
+            deadBytesSinceVacuum[tableName] += p->slot(loc.slotID).offset == oldOffset ? oldLength - raw.size() : oldLength;
+            p->setPageLSN(logHeapOp(LogType::HEAP_UPDATE, tableName, loc.pageIndex, loc.slotID, raw.data(), raw.size()));
+            p.markDirty();
+            freeSpaceMap(tableName)->update(loc.pageIndex, p->freeSpace());
+            return reindex();
+        }
 
-            for (uint16_t s = 0; s < p.slots.size(); ++s) {
-                if (!p.slots[s].active) continue;
-                vector<uint8_t> raw;
-                if (p.readRawRecord(s, raw)) {
-                    Record rec;
-                    if (deserializeRecord(raw, rec)) {
-                        records.push_back(rec);
-                    }
-                }
-            }
+        // 2. relocate; the home slot must be able to hold the stub afterwards
+        bool isHome = e.state == SLOT_LIVE;
+        if (isHome && e.length < FORWARD_BYTES && p->freeSpace() < FORWARD_BYTES) return false;
+        optional<RecordLocation> target = placeRecord(tableName, withHome(bytes), SLOT_MOVED);
+        if (!target.has_value()) return false;
+
+        vector<uint8_t> stub(FORWARD_BYTES);
+        memcpy(stub.data(), &target->pageIndex, 4);
+        memcpy(stub.data() + 4, &target->slotID, 2);
+        deadBytesSinceVacuum[tableName] += isHome && oldLength >= FORWARD_BYTES ? oldLength - FORWARD_BYTES : oldLength;
+        if (isHome) {
+            p->setForward(loc.slotID, *target);
+            p->setPageLSN(logHeapOp(LogType::HEAP_FORWARD, tableName, loc.pageIndex, loc.slotID, stub.data(), stub.size()));
+            p.markDirty();
+            freeSpaceMap(tableName)->update(loc.pageIndex, p->freeSpace());
+            return reindex();
         }
-        in.close();
-        return records;
+
+        // moved again: drop the old copy and repoint the stub at home
+        p->deleteSlot(loc.slotID);
+        p->setPageLSN(logHeapOp(LogType::HEAP_DELETE, tableName, loc.pageIndex, loc.slotID, nullptr, 0));
+        p.markDirty();
+        p.release();
+        PageHandle h(bufferPool, tableName, home.pageIndex);
+        if (!h.valid() || !h->setForward(home.slotID, *target)) return false;
+        h->setPageLSN(logHeapOp(LogType::HEAP_FORWARD, tableName, home.pageIndex, home.slotID, stub.data(), stub.size()));
+        h.markDirty();
+        return reindex();
     }
 
-    // --- Meta file helpers ---
-    // meta format: columns=col1:TYPE,col2:TYPE,col3:TYPE
-    bool StorageEngine::writeMetaFile(const string& tableName, const vector<Column>& columns) const {
-        string path = tableMetaPath(tableName);
-        ofstream m(path, ios::trunc);
-        if (!m) return false;
+    vector<Record> StorageEngine::selectAll(const string& tableName) {
+        // one batch holding the whole table
+        vector<Record> rows;
+        openCursor(tableName, SIZE_MAX).next(rows);
+        return rows;
+    }
 
-        m << "table=" << tableName << "\n";
-        m << "columns=";
-        for (size_t i = 0; i < columns.size(); ++i) {
-            m << columns[i].name << ":" << columns[i].type;
-            if (i + 1 < columns.size()) m << ",";
+    vector<Record> StorageEngine::selectRange(const string& tableName, int from, int to) {
+        vector<Record> rows, batch;
+        TableCursor cursor = openRangeCursor(tableName, from, to);
+        while (cursor.next(batch)) move(batch.begin(), batch.end(), back_inserter(rows));
+
+        // HEAP, HASH and COLUMNAR return rows in storage order: order by id like a tree walk
+        StructureType type = getStructureType(tableName);
+        if (type == StructureType::HEAP || type == StructureType::HASH || type == StructureType::COLUMNAR) {
+            sort(rows.begin(), rows.end(), [](const Record& a, const Record& b) {
+                return get<int>(a.fields[0]) < get<int>(b.fields[0]);
+            });
         }
-        m << "\n";
-        m.close();
-        return true;
+        return rows;
+    }
+
+    void StorageEngine::setScanMode(ScanMode mode) {
+        lock_guard<recursive_mutex> lock(engineMutex);
+        scanMode = mode;
     }
 
-    optional<vector<Column>> StorageEngine::readMetaFile(const string& tableName) const {
-        string path = tableMetaPath(tableName);
-        if (!fs::exists(path)) return nullopt;
-
-        ifstream m(path);
-        if (!m) return nullopt;
-
-        string line;
-        vector<Column> cols;
-        while (getline(m, line)) {
-            // trim
-            if (line.rfind("columns=", 0) == 0) {
-                string rest = line.substr(strlen("columns="));
-                // split by ','
-                stringstream ss(rest);
-                string token;
-                while (getline(ss, token, ',')) {
-                    // token like name:TYPE
-                    size_t pos = token.find(':');
-                    if (pos == string::npos) continue;
-                    string cname = token.substr(0, pos);
-                    string ctype = token.substr(pos + 1);
-                    // trim spaces
-                    auto trim = [](string s)->string{
-                        size_t a = 0;
-                        while (a < s.size() && isspace((unsigned char)s[a])) a++;
-                        size_t b = s.size();
-                        while (b> a && isspace((unsigned char)s[b-1])) b--;
-                        return s.substr(a, b-a);
-                    };
-                    cname = trim(cname);
-                    ctype = trim(ctype);
-                    cols.push_back({cname, ctype});
+    // Walks every live slot of a HEAP table (from firstPage/firstSlot on) and hands
+    // the visitor a pointer to the record bytes; nothing is decoded here. In MMAP
+    // mode the bytes come straight from the mapped file (after writing back the
+    // table's dirty pages so the mapping is current), otherwise from pinned buffer
+    // pool frames, with the pages after the current one read ahead.
+    void StorageEngine::scanHeap(const string& tableName, const HeapVisitor& visit, uint32_t firstPage, uint16_t firstSlot) {
+        uint32_t pages = pageCount(tableName);
+
+        if (scanMode == ScanMode::MMAP) {
+            bufferPool.flushTable(tableName);
+            PagedFile* file = tableFile(tableName);
+            const uint8_t* base = file ? file->mapPages(true) : nullptr;
+            if (base) {
+                for (uint32_t i = firstPage; i < pages; ++i) {
+                    PageView view(base + static_cast<size_t>(i) * file->pageSize(), file->pageSize());
+                    uint16_t n = view.slotCount();
+                    for (uint16_t s = i == firstPage ? firstSlot : 0; s < n; ++s) {
+                        SlotEntry e = view.slot(s);
+                        if (!e.holdsRecord()) continue;
+                        if (!visit(i, s, view.record(e), e.recordLength())) return;
+                    }
                 }
+                return;
             }
+            // no mmap on this platform: fall through to the buffered scan
         }
-        m.close();
-        return cols;
+
+        PagedFile* file = tableFile(tableName);
+        if (!file) return;
+        unique_ptr<ReadAhead>& ahead = readAheads[tableName];
+        if (!ahead) ahead = make_unique<ReadAhead>(*file);
+        for (uint32_t i = firstPage; i < pages; ++i) {
+            if (!bufferPool.isResident(tableName, i)) ahead->advance(i);
+            PageHandle p(bufferPool, tableName, i);
+            if (!p.valid()) break;
+            for (uint16_t s = i == firstPage ? firstSlot : 0; s < p->slotCount(); ++s) {
+                SlotEntry e = p->slot(s);
+                if (!e.holdsRecord()) continue;
+                if (!visit(i, s, p->data.data() + e.recordOffset(), e.recordLength())) return;
+            }
+        }
+        readAheads.erase(tableName);
     }
 
+
     // --------------------------------------------------------------------------------------
     // SEARCH (For Benchmarking)
     // --------------------------------------------------------------------------------------
     bool StorageEngine::search(const std::string& tableName, int id) {
-        if (tableStructures.find(tableName) == tableStructures.end()) {
-            // Attempt to load metadata to determine structure type if not already known
-            if (readMetaFile(tableName).has_value()) {
-                // Default to HEAP if no specific structure type is stored in metadata
-                // For benchmarking, we assume structure type is set during table creation
-                // or inferred from existing data. If not found, treat as HEAP.
-                tableStructures[tableName] = StructureType::HEAP;
-            } else {
-                return false; // Table does not exist
-            }
-        }
+        lock_guard<recursive_mutex> lock(engineMutex);
+        const TableInfo* table = openTable(tableName);
+        if (!table) return false; // Table does not exist
 
-        StructureType type = tableStructures[tableName];
+        StructureType type = table->structure;
 
         if (type == StructureType::AVL) {
             if (avlTables.find(tableName) != avlTables.end()) {
@@ -587,49 +877,92 @@ namespace ChronoDB {
                 return res.has_value();
             }
         }
+        else if (type == StructureType::BTREE) {
+            // BTREE: one root-to-leaf descent over the table file
+            return findTreeRecord(tableName, id).has_value();
+        }
+        else if (type == StructureType::COLUMNAR) {
+            // COLUMNAR: the in-memory id map, no page read
+            return columnarTables[tableName].rowOfId.count(id) > 0;
+        }
         else { // StructureType::HEAP or default
-            // HEAP: Linear Scan
-            // Read all blocks
-            // Reuse selectAll logic implicitly or just scan using selectAll for now
-            // because strict file parsing duplication is bad.
-            auto rows = selectAll(tableName);
-            for(auto& rec : rows) {
-                // Assuming ID is always the first field and an integer
-                if (get<int>(rec.fields[0]) == id) return true;
-            }
+            // HEAP: primary-key index lookup (linear scan for tables without a schema)
+            return locateRecord(tableName, id).has_value();
         }
         return false;
     }
 
     vector<Column> StorageEngine::getTableColumns(const string& tableName) const {
-        auto opt = readMetaFile(tableName);
-        if (!opt.has_value()) return {};
-        return opt.value();
+        const TableInfo* table = getTableInfo(tableName);
+        if (!table) return {};
+        return table->columns;
+    }
+
+    const TableInfo* StorageEngine::getTableInfo(const string& tableName) const {
+        lock_guard<recursive_mutex> lock(engineMutex);
+        return catalog.find(tableName);
+    }
+
+    const RecordCodec& StorageEngine::codecFor(const string& tableName) const {
+        static const RecordCodec tagged;
+        const TableInfo* table = getTableInfo(tableName);
+        return table ? table->codec : tagged;
     }
 
     StorageEngine::StructureType StorageEngine::getStructureType(const string& tableName) const {
-        if (tableStructures.find(tableName) != tableStructures.end()) {
-            return tableStructures.at(tableName);
-        }
-        return StructureType::HEAP;
+        const TableInfo* table = getTableInfo(tableName);
+        return table ? table->structure : StructureType::HEAP;
     }
 
-    // GUI Helper: Scan directory for tables
-    vector<string> StorageEngine::getTableNames() const {
-        vector<string> tables;
-        if (!fs::exists(storageDirectory)) return tables;
+    // The first use of an AVL/BST/HASH/COLUMNAR table in this run rebuilds it from its
+    // snapshot. A table without one starts empty, unless it is a COLUMNAR table
+    // with segment pages on disk. That case and a damaged snapshot are reported
+    // and the table left unopened, so no checkpoint overwrites its files.
+    const TableInfo* StorageEngine::openTable(const string& tableName) {
+        const TableInfo* table = catalog.find(tableName);
+        if (!table) return nullptr;
+        bool loaded = true;
+        if (table->structure == StructureType::AVL) loaded = avlTables.count(tableName) > 0;
+        else if (table->structure == StructureType::BST) loaded = bstTables.count(tableName) > 0;
+        else if (table->structure == StructureType::HASH) loaded = hashTables.count(tableName) > 0;
+        else if (table->structure == StructureType::COLUMNAR) loaded = columnarTables.count(tableName) > 0;
+        if (loaded) return table;
+        SnapshotLoad snapshot = loadSnapshot(tableName, table->structure);
+        if (snapshot == SnapshotLoad::DAMAGED) {
+            cerr << "Error: snapshot " << tableSnapshotPath(tableName) << " of table '" << tableName
+                 << "' is damaged" << endl;
+            return nullptr;
+        }
+        if (snapshot == SnapshotLoad::MISSING && table->structure == StructureType::COLUMNAR &&
+            !columnFilesEmpty(tableName)) {
+            cerr << "Error: snapshot " << tableSnapshotPath(tableName) << " of table '" << tableName
+                 << "' is missing; its column files are left as they are" << endl;
+            return nullptr;
+        }
+        // create the (possibly empty) structure so the snapshot is only looked for once
+        if (table->structure == StructureType::AVL) avlTables[tableName];
+        else if (table->structure == StructureType::BST) bstTables[tableName];
+        else if (table->structure == StructureType::HASH) hashTables[tableName];
+        else if (snapshot == SnapshotLoad::MISSING) resetColumnarTable(tableName);
+        return table;
+    }
 
-        for (const auto& entry : fs::directory_iterator(storageDirectory)) {
-            if (entry.path().extension() == ".meta") {
-                // filename without extension is table name
-                tables.push_back(entry.path().stem().string());
-            }
+    // Page counts of the tables opened in this run go into the catalog with each checkpoint
+    void StorageEngine::saveCatalogStats() {
+        for (const auto& entry : openFiles) {
+            if (catalog.find(entry.first)) catalog.setPageCount(entry.first, entry.second->pageCount());
         }
-        return tables;
+        catalog.saveIfDirty();
+    }
+
+    // GUI Helper: table names, sorted (no directory scan)
+    vector<string> StorageEngine::getTableNames() const {
+        lock_guard<recursive_mutex> lock(engineMutex);
+        return catalog.tableNames();
     }
 
     bool StorageEngine::tableExists(const string& tableName) const {
-         return fs::exists(tableMetaPath(tableName));
+        return getTableInfo(tableName) != nullptr;
     }
 
 } // namespace ChronoDB
\ No newline at end of file
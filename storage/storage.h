@@ -7,8 +7,24 @@
 #include <fstream>
 #include <optional>
 #include "../utils/types.h"
-#include "../utils/types.h"
+#include "page.h"
+#include "buffer_pool.h"
+#include "paged_file.h"
+#include "read_ahead.h"
+#include "free_space_map.h"
+#include "bplus_tree.h"
+#include "catalog.h"
+#include "record_view.h"
+#include "column_segment.h"
+#include "wal.h"
+#include <memory>
+#include <functional>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 #include <unordered_map>
+#include <unordered_set>
 #include "../src/structures/avl_tree.h"
 #include "../src/structures/bst.h"
 #include "../src/structures/hash_table.h"
@@ -16,62 +32,161 @@ using namespace std;
 
 namespace ChronoDB {
 
-    // Column description
-    struct Column {
-        string name;   // column name (e.g., id, name)
-        string type;   // INT, FLOAT, STRING
-    };
-
     // Full schema for a table
     struct TableSchema {
         vector<Column> columns;
         string primaryKey;
     }; 
 
-    // -------- Page Constants --------
-    static constexpr uint32_t PAGE_SIZE = 8192; // 8 KB
-    static constexpr uint16_t PAGE_HEADER_RESERVED = 64;
-
-    struct SlotEntry {
-        uint16_t offset;
-        uint16_t length;
-        bool active;
-        SlotEntry(uint16_t o = 0, uint16_t l = 0, bool a = true)
-            : offset(o), length(l), active(a) {}
+    struct TableMeta {
+        string tableName;
+        vector<Column> columns;
     };
 
-    struct Page {
-        uint32_t pageID = 0;
-        uint16_t slotCount = 0;
-        uint16_t freeSpaceOffset = PAGE_HEADER_RESERVED;
-
-        vector<SlotEntry> slots;
-        vector<uint8_t> data;
-
-        Page() {
-            data.resize(PAGE_SIZE, 0);
-        }
+    class StorageEngine;
+
+    // In-memory part of a COLUMNAR table (storage/columnar_table.cpp). Rows are
+    // numbered in insertion order; rows below sealedRows are in the column files
+    // (<table>.c<i>, one segment per page), newer ones wait in tail.
+    struct ColumnarTable {
+        uint32_t sealedRows = 0;
+        vector<vector<uint32_t>> segmentStarts; // per column: first row of each segment (segment i is page i)
+        vector<Record> tail;
+        vector<bool> deleted;                   // per row; a deleted row keeps its place in the segments
+        unordered_map<int, uint32_t> rowOfId;   // live rows by primary key
+        // per column: the segment decoded last, kept for the next read (segments never change)
+        struct DecodedSegment {
+            uint32_t segment = UINT32_MAX;
+            vector<RecordValue> values;
+        };
+        vector<DecodedSegment> decoded;
+
+        uint32_t rowCount() const { return sealedRows + static_cast<uint32_t>(tail.size()); }
+    };
 
-        uint16_t usedDataBytes() const { return freeSpaceOffset; }
-        uint16_t freeSpace() const;
-        optional<uint16_t> insertRawRecord(const vector<uint8_t>& rec);
-        bool deleteSlot(uint16_t slotID);
-        bool readRawRecord(uint16_t slotID, vector<uint8_t>& out) const;
+    // Pull-based scan of one table (storage/table_cursor.cpp). Each next() reads at
+    // most one batch under the engine lock, so memory stays bounded by the batch
+    // size and other statements run between batches. Not a snapshot: rows changed
+    // while the cursor is open may or may not be returned.
+    class TableCursor {
+    public:
+        static constexpr size_t DEFAULT_BATCH_ROWS = 1024;
+
+        // Replaces batch with the next rows; false once the scan is finished
+        bool next(vector<Record>& batch);
+        // One row at a time (reads a batch behind the scenes)
+        bool next(Record& row);
+
+        // Shows every remaining row to visit, one batch per engine lock. Fields are
+        // read in place; the view is only valid during the call.
+        using RowVisitor = function<void(const RecordView&)>;
+        void forEach(const RowVisitor& visit);
+        // forEach over the rows that pass test, which may read only field `column`.
+        // A COLUMNAR table decodes that column first and the others only for the
+        // rows that pass.
+        using RowTest = function<bool(const RecordView&)>;
+        void forEachWhere(size_t column, const RowTest& test, const RowVisitor& visit);
 
-        void serializeToBuffer(vector<uint8_t>& buffer) const;
-        void deserializeFromBuffer(const vector<uint8_t>& buffer);
-    };
+    private:
+        friend class StorageEngine;
+        TableCursor(StorageEngine* engine, const string& tableName, StructureType structure,
+                    size_t batchRows, int from, int to, bool bounded);
 
-    struct TableMeta {
+        StorageEngine* engine;
         string tableName;
-        vector<Column> columns;
+        StructureType structure;
+        size_t batchRows;
+        int from, to;             // id bounds (INT_MIN..INT_MAX for a full scan)
+        bool bounded;
+        bool exhausted = false;
+        uint64_t rowsReturned = 0;
+        // AVL / BST / BTREE: resume at nextId, skipping the rows with that id already returned
+        int nextId;
+        size_t skipAtNextId = 0;
+        // HEAP: next slot to read
+        uint32_t page = 0;
+        uint16_t slot = 0;
+        // HASH: next chain entry
+        size_t bucket = 0;
+        size_t position = 0;
+        // COLUMNAR: next row number
+        uint32_t row = 0;
+        // set during forEachWhere
+        const RowTest* filter = nullptr;
+        size_t filterColumn = 0;
+        // batch behind next(Record&)
+        vector<Record> pending;
+        size_t pendingPos = 0;
     };
 
     class StorageEngine {
     public:
-        StorageEngine(const string& storageDir = "./data");
+        using StructureType = ChronoDB::StructureType;
+
+        StorageEngine(const string& storageDir = "./data", size_t bufferPoolBytes = DEFAULT_BUFFER_POOL_BYTES);
         ~StorageEngine();
 
+        // Checkpoint: writes every dirty cached page back to the table files and trims the log
+        void flush();
+
+        // What the startup redo pass did
+        struct RecoveryStats {
+            uint64_t startLSN = 0;        // low-water mark of the last checkpoint
+            uint64_t bytesReplayed = 0;
+            uint64_t recordsReplayed = 0;
+            double milliseconds = 0;
+        };
+        const RecoveryStats& getRecoveryStats() const { return recoveryStats; }
+
+        // Durability of modifying statements (see WriteAheadLog)
+        void setDurabilityMode(DurabilityMode mode);
+        DurabilityMode getDurabilityMode() const;
+        // Memory budget of the page cache in bytes
+        void setBufferPoolSize(size_t bytes);
+        // Table files bypass the OS page cache (O_DIRECT), so each page is cached
+        // once, in the buffer pool. False if a file fell back to cached I/O (no
+        // O_DIRECT on this platform or file system).
+        bool setDirectIo(bool enabled);
+        bool getDirectIo() const { return directIo; }
+
+        // How HEAP scans read pages: through the buffer pool, or zero-copy from an
+        // mmap of the table file (read-heavy analytics)
+        enum class ScanMode { BUFFERED, MMAP };
+        void setScanMode(ScanMode mode);
+        ScanMode getScanMode() const { return scanMode; }
+
+        // Space usage of a HEAP table
+        struct HeapStats {
+            uint32_t pageSize = DEFAULT_PAGE_SIZE;
+            uint32_t pages = 0;
+            uint64_t liveBytes = 0;   // held by records, forwarding stubs and moved records
+            uint64_t deadBytes = 0;   // reclaimable: dead records, orphaned bytes, dead slot entries
+
+            double fillFactor() const {
+                return pages ? static_cast<double>(liveBytes) / (static_cast<double>(pages) * (pageSize - PAGE_HEADER_RESERVED)) : 0.0;
+            }
+            double deadRatio() const {
+                return liveBytes + deadBytes ? static_cast<double>(deadBytes) / (liveBytes + deadBytes) : 0.0;
+            }
+        };
+
+        struct VacuumResult {
+            HeapStats before;
+            HeapStats after;
+            uint32_t pagesCompacted = 0;
+            uint32_t recordsMoved = 0;
+            uint32_t pagesTruncated = 0;
+        };
+
+        HeapStats heapStats(const string& tableName);
+        // Compacts every page of a HEAP table, empties sparse pages into earlier pages
+        // with room and gives the empty tail back to the file system. Runs online:
+        // other statements interleave between pages.
+        optional<VacuumResult> vacuum(const string& tableName);
+        // Background thread that vacuums tables once enough of them is dead space
+        void setAutoVacuum(bool enabled);
+        bool getAutoVacuum() const { return autoVacuumThread.joinable(); }
+
         // Create table WITH schema
         bool createTable(const string& tableName, const vector<Column>& columns);
 
@@ -79,11 +194,42 @@ namespace ChronoDB {
         bool createTable(const string& tableName);
 
         bool insertRecord(const string& tableName, const Record& rec);
+        // Many rows as one statement: every row is checked against the schema before
+        // any is stored (0 and nothing stored if one does not fit), HEAP rows fill
+        // pages in order, and the log is flushed once for the whole batch. Returns
+        // how many rows were stored: the rows are stored in order, and a failure
+        // midway keeps (and commits) the ones before it.
+        size_t insertRecords(const string& tableName, const vector<Record>& rows);
         vector<Record> selectAll(const string& tableName);
+        // Streaming scans: storage order for HEAP/HASH, id order for AVL/BST/BTREE.
+        // A missing table gives a cursor with no rows.
+        TableCursor openCursor(const string& tableName, size_t batchRows = TableCursor::DEFAULT_BATCH_ROWS);
+        // Only rows with from <= id <= to; AVL/BST/BTREE seek to `from` and stop after `to`
+        TableCursor openRangeCursor(const string& tableName, int from, int to,
+                                    size_t batchRows = TableCursor::DEFAULT_BATCH_ROWS);
+        // Records with from <= id <= to in id order; BTREE tables walk their leaf chain
+        vector<Record> selectRange(const string& tableName, int from, int to);
+
+        // Point lookup by primary key; HEAP tables go through their primary-key index
+        optional<Record> findRecord(const string& tableName, int id);
 
         bool updateRecord(const string& tableName, int id, const Record& newRecord);
         bool deleteRecord(const string& tableName, int id);
 
+        // What a bulk load did
+        struct LoadResult {
+            uint64_t rowsLoaded = 0;
+            uint64_t rowsRejected = 0;  // malformed, wrong type or too large
+            double milliseconds = 0;
+        };
+        // COPY FROM: loads a CSV file (an optional first line naming the columns is
+        // skipped) or a file written by exportTable. Rows replace existing ones with
+        // the same id, as INSERT does. nullopt if the table has no INT first column
+        // or the file cannot be read.
+        optional<LoadResult> bulkLoad(const string& tableName, const string& path);
+        // COPY TO: writes every row in the binary format bulkLoad reads; the row count
+        optional<uint64_t> exportTable(const string& tableName, const string& path);
+
         // BENCHMARKING AID
         bool search(const std::string& tableName, int id); // Returns true if found
 
@@ -92,6 +238,9 @@ namespace ChronoDB {
 
         // Schema access
         vector<Column> getTableColumns(const string& tableName) const;
+        // Cached schema, structure and column lookups (nullptr if no such table).
+        // Stays valid for the engine's lifetime.
+        const TableInfo* getTableInfo(const string& tableName) const;
 
         // === NEW: Full schema I/O ===
         TableSchema loadSchema(const string& tableName) const;
@@ -99,49 +248,190 @@ namespace ChronoDB {
 
     private:
         string storageDirectory;
+        WriteAheadLog wal;
+        BufferPool bufferPool;
+        uint64_t lastWriteLSN = 0;
+        uint64_t lastCheckpointLSN = 0;
+        chrono::steady_clock::time_point lastCheckpointTime = chrono::steady_clock::now();
+        RecoveryStats recoveryStats;
+
+        // Public entry points hold this so the autovacuum thread can run next to them
+        mutable recursive_mutex engineMutex;
+
+        // Dead bytes created per table since its last VACUUM (estimate for autovacuum)
+        unordered_map<string, uint64_t> deadBytesSinceVacuum;
+        thread autoVacuumThread;
+        mutex autoVacuumMutex;
+        condition_variable autoVacuumWake;
+        bool autoVacuumStop = false;
+
+        static constexpr chrono::seconds AUTOVACUUM_INTERVAL{5};
+        static constexpr uint64_t AUTOVACUUM_MIN_DEAD_BYTES = 256 * 1024;
+        static constexpr double AUTOVACUUM_DEAD_RATIO = 0.2;
+        // VACUUM empties pages filled below this fraction into earlier pages (and any page in the tail)
+        static constexpr double VACUUM_MERGE_FILL = 0.5;
+
+        // Fuzzy checkpoint after this much log or this much time, whichever comes first.
+        // Recovery replays at most about two intervals of log.
+        static constexpr uint64_t CHECKPOINT_LOG_BYTES = 16ull * 1024 * 1024;
+        static constexpr chrono::seconds CHECKPOINT_INTERVAL{30};
+
+        // Open table files: TableName -> descriptor with cached page count
+        unordered_map<string, unique_ptr<PagedFile>> openFiles;
+        // Free-space maps of the HEAP tables touched so far (loaded on first use)
+        unordered_map<string, unique_ptr<FreeSpaceMap>> freeSpaceMaps;
+        // Primary-key indexes of HEAP tables: id -> home record ID (opened on first use)
+        unordered_map<string, unique_ptr<BPlusTree>> primaryIndexes;
+        // Read-ahead of the BUFFERED HEAP scan in progress per table; kept between
+        // cursor batches and dropped when the scan reaches the last page
+        unordered_map<string, unique_ptr<ReadAhead>> readAheads;
+        bool directIo = false;
+        ScanMode scanMode = ScanMode::BUFFERED;
+
+        // Visitor over raw live slots: (pageIndex, slotID, bytes, length) -> keep going?
+        using HeapVisitor = function<bool(uint32_t, uint16_t, const uint8_t*, uint16_t)>;
+        void scanHeap(const string& tableName, const HeapVisitor& visit, uint32_t firstPage = 0, uint16_t firstSlot = 0);
+
+        // cursors (storage/table_cursor.cpp)
+        friend class TableCursor;
+        void readCursorBatch(TableCursor& cursor, const TableCursor::RowVisitor& emit);
+        size_t readOrderedBatch(TableCursor& cursor, const TableCursor::RowVisitor& emit);
 
         string tableDataPath(const string& tableName) const;
-        string tableMetaPath(const string& tableName) const;
-
-        static void serializeRecord(const Record& r, vector<uint8_t>& out);
-        static bool deserializeRecord(const vector<uint8_t>& in, Record& out);
-        vector<Record> loadAllRecords(const string& tableName) const;
-
-        uint32_t pageCount(const string& tableName) const;
-        uint32_t appendEmptyPage(const string& tableName);
-
-        // helpers
-        bool writeMetaFile(const string& tableName, const vector<Column>& columns) const;
-        optional<vector<Column>> readMetaFile(const string& tableName) const;
-        static bool typeStringMatchesValue(const string& typeStr, const RecordValue& v);
+        string tableFsmPath(const string& tableName) const;
+        string pagedFilePath(const string& fileKey) const;
+        static string indexFileKey(const string& tableName) { return tableName + ".idx"; }
+        // Page size of a paged file: its table's (the index and column files of a
+        // table share it), DEFAULT_PAGE_SIZE for a file of no known table
+        uint32_t pageSizeOf(const string& fileKey) const;
+
+        // The row codec of a table (TAGGED for one without a schema)
+        const RecordCodec& codecFor(const string& tableName) const;
+        optional<RecordLocation> locateRecord(const string& tableName, int id);
+
+        bool readPageFromDisk(const string& tableName, uint32_t pageIndex, Page& outPage);
+        bool writePageToDisk(const string& tableName, uint32_t pageIndex, const Page& page);
+        PagedFile* tableFile(const string& tableName, bool create = false);
+        uint32_t pageCount(const string& tableName);
+        optional<uint32_t> appendEmptyPage(const string& tableName);
+        FreeSpaceMap* freeSpaceMap(const string& tableName);
+        void saveFreeSpaceMaps();
+
+        // primary-key index (storage/primary_index.cpp)
+        BPlusTree* primaryIndex(const string& tableName);
+        BPlusTree* primaryIndexForWrite(const string& tableName);
+        void rebuildPrimaryIndex(const string& tableName, BPlusTree& index);
+        void markIndexesClean();
+        void indexPut(const string& tableName, int id, const RecordLocation& home);
+        void indexRemove(const string& tableName, int id);
+
+        // COLUMNAR tables (storage/columnar_table.cpp)
+        static string columnFileKey(const string& tableName, size_t column) {
+            return tableName + ".c" + to_string(column);
+        }
+        void resetColumnarTable(const string& tableName);
+        bool columnFilesEmpty(const string& tableName);
+        bool insertColumnarRecord(const string& tableName, const Record& rec);
+        bool updateColumnarRecord(const string& tableName, int id, const Record& newRecord);
+        bool deleteColumnarRecord(const string& tableName, int id);
+        optional<Record> findColumnarRecord(const string& tableName, int id);
+        bool sealColumnarTail(const string& tableName, ColumnarTable& table);
+        bool readColumnSegment(const string& tableName, size_t column, uint32_t segment, vector<RecordValue>& out);
+        const RecordValue* columnValue(const string& tableName, ColumnarTable& table, size_t column, uint32_t row);
+        size_t readColumnarBatch(TableCursor& cursor, const TableCursor::RowVisitor& emit);
+        void appendColumnarState(const string& tableName, vector<uint8_t>& out);
+        bool loadColumnarState(const string& tableName, vector<Record>& tail, const vector<uint8_t>& in, size_t pos);
+
+        // bulk load steps (storage/bulk_load.cpp); each returns the rows it stored
+        size_t bulkLoadHeap(const string& tableName, const vector<pair<int32_t, vector<uint8_t>>>& rows);
+        size_t bulkLoadTree(const string& tableName, vector<pair<int32_t, vector<uint8_t>>>& rows);
+        size_t bulkLoadOrdered(const string& tableName, vector<Record>& rows);
+
+        // BTREE tables (storage/btree_table.cpp); the row changes leave the commit to their caller
+        BPlusTree* btreeTable(const string& tableName);
+        void logTreeChange(const string& tableName, BPlusTree::Change change, const BPlusTree::ChangedPages& pages,
+                           const vector<uint8_t>& payload);
+        void redoTreeImages(const LogRecord& rec);
+        bool insertTreeRecord(const string& tableName, const Record& rec);
+        bool updateTreeRecord(const string& tableName, int id, const Record& newRecord);
+        bool deleteTreeRecord(const string& tableName, int id);
+        optional<Record> findTreeRecord(const string& tableName, int id);
+
+        // slot-level HEAP changes (each logs and dirties only the pages it touches)
+        // pageLimit restricts placement to earlier pages (no page is appended then)
+        optional<RecordLocation> placeRecord(const string& tableName, const vector<uint8_t>& raw, uint8_t state,
+                                             uint32_t pageLimit = UINT32_MAX);
+        bool removeRecordAt(const string& tableName, const RecordLocation& loc);
+        bool replaceRecordAt(const string& tableName, const RecordLocation& loc, const vector<uint8_t>& bytes);
+        // Stores an encoded row and indexes it; an existing row with its id is removed first
+        bool insertHeapRow(const string& tableName, const vector<uint8_t>& bytes);
+
+        // vacuum steps
+        void logPageImage(const string& tableName, uint32_t pageIndex, Page& page);
+        bool compactPage(const string& tableName, uint32_t pageIndex);
+        uint32_t emptyPage(const string& tableName, uint32_t pageIndex, bool onlyIfSparse, bool& nowEmpty);
+        uint32_t truncateEmptyTail(const string& tableName);
+        void autoVacuumLoop();
+
+        // logging / recovery
+        uint64_t logHeapOp(LogType type, const string& tableName, uint32_t pageIndex, uint16_t slotID,
+                           const uint8_t* bytes, size_t len);
+        bool commitWrite(unique_lock<recursive_mutex>& lock);
+        void checkpoint();
+        bool writeMasterRecord(uint64_t checkpointLSN, uint64_t lowWaterLSN);
+        bool readMasterRecord(uint64_t& checkpointLSN, uint64_t& lowWaterLSN) const;
+        void recover();
+        void redo(const LogRecord& rec);
 
         // --- Multi-Structure Management ---
-        enum class StructureType { HEAP, AVL, BST, HASH };
-        
-        // Registry: TableName -> StructureType
-        unordered_map<string, StructureType> tableStructures;
+        // Registry: TableName -> schema and StructureType (loaded once at startup)
+        Catalog catalog;
+        // Catalog entry of a table, with its in-memory structure loaded from its
+        // snapshot on first use. nullptr if the table does not exist.
+        const TableInfo* openTable(const string& tableName);
+        void saveCatalogStats();
+
+        // Disk-resident B+Trees of BTREE tables, keyed by primary key (opened on first use)
+        unordered_map<string, unique_ptr<BPlusTree>> btreeTables;
 
-        // In-Memory Structures (since we aren't persisting them to disk for this project demo)
+        // In-Memory Structures, written to <table>.snap at checkpoints
         // TableName -> Instance
         unordered_map<string, AVLTree> avlTables;
         unordered_map<string, BST> bstTables;
         unordered_map<string, HashTable> hashTables;
+        // COLUMNAR tables: segments on disk, the rest in memory and in the snapshot
+        unordered_map<string, ColumnarTable> columnarTables;
+        // Changed since their last snapshot
+        unordered_set<string> dirtySnapshots;
+
+        // snapshots (storage/structure_snapshot.cpp)
+        string tableSnapshotPath(const string& tableName) const;
+        bool saveSnapshot(const string& tableName);
+        void saveSnapshots();
+        enum class SnapshotLoad { LOADED, MISSING, DAMAGED };
+        SnapshotLoad loadSnapshot(const string& tableName, StructureType type);
 
     public:
-        // Expose method to create with specific structure
-        bool createTable(const string& tableName, const vector<Column>& columns, const string& structureType);
+        // Expose method to create with specific structure; compactRows stores the
+        // rows in the smaller COMPACT format (varint INTs, no type tags). pageSize
+        // (isValidPageSize) is fixed for the table's lifetime: large pages suit
+        // scans, small ones point lookups, and a row must fit in one page.
+        bool createTable(const string& tableName, const vector<Column>& columns, const string& structureType,
+                         bool compactRows = false, uint32_t pageSize = DEFAULT_PAGE_SIZE);
         
         // Expose method to get structure type
         StructureType getStructureType(const string& tableName) const;
         
         // Expose getters for specific tables (for Parser access to BFS/DFS)
         BST* getBST(const string& tableName) {
+             lock_guard<recursive_mutex> lock(engineMutex);
+             openTable(tableName);
              if (bstTables.find(tableName) != bstTables.end()) return &bstTables[tableName];
              return nullptr;
         }
 
         // GUI HELPERS
-        // Returns list of all table names found in data directory
+        // Returns the names of all tables in the catalog, sorted
         vector<string> getTableNames() const;
         // Returns true if table exists (used for GUI checks)
         bool tableExists(const string& tableName) const;
@@ -0,0 +1,129 @@
+// structure_snapshot.cpp
+#include "storage.h"
+#include <cstring>
+#include <iostream>
+#include <filesystem>
+#include <algorithm>
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace ChronoDB {
+
+    // ---------- AVL / BST / HASH / COLUMNAR snapshots ----------
+    // The in-memory structures are written to <table>.snap at every checkpoint
+    // (only those changed since the last one) and read back the first time the
+    // table is used after a restart. Layout:
+    //   magic u32 | structure u8 | count u32 | count x (length u32 + serialised record)
+    // Records are stored in the order that rebuilds the structure in O(n):
+    //   AVL:  sorted by id, rebuilt as a balanced tree from the middle outwards
+    //   BST:  pre-order, rebuilt with the same shape (BFS/DFS output is unchanged)
+    //   HASH: bucket order, re-appended to the same chains
+    //   COLUMNAR: the unsealed tail, followed by the segment directory and the
+    //             deleted rows (storage/columnar_table.cpp)
+    // Changes made after the last checkpoint are lost in a crash.
+
+    static constexpr uint32_t SNAPSHOT_MAGIC = 0x504E5343; // "CSNP"
+    static constexpr size_t SNAPSHOT_HEADER_BYTES = 9;
+
+    string StorageEngine::tableSnapshotPath(const string& tableName) const {
+        return storageDirectory + "/" + tableName + ".snap";
+    }
+
+    // Replaced as a whole (see replaceFile) so a crash never leaves half a snapshot
+    bool StorageEngine::saveSnapshot(const string& tableName) {
+        StructureType type = getStructureType(tableName);
+        vector<Record> records;
+        const vector<Record>* rows = &records;
+        if (type == StructureType::AVL) records = avlTables[tableName].getAllSorted();
+        else if (type == StructureType::BST) records = bstTables[tableName].getAllPreOrder();
+        else if (type == StructureType::HASH) records = hashTables[tableName].getAll();
+        else if (type == StructureType::COLUMNAR) rows = &columnarTables[tableName].tail;
+        else return false;
+
+        vector<uint8_t> out(SNAPSHOT_HEADER_BYTES);
+        uint8_t structure = static_cast<uint8_t>(type);
+        uint32_t count = static_cast<uint32_t>(rows->size());
+        memcpy(out.data(), &SNAPSHOT_MAGIC, 4);
+        out[4] = structure;
+        memcpy(out.data() + 5, &count, 4);
+        vector<uint8_t> bytes;
+        for (const Record& rec : *rows) {
+            RecordCodec::encodeTagged(rec, bytes);
+            uint32_t len = static_cast<uint32_t>(bytes.size());
+            size_t pos = out.size();
+            out.resize(pos + 4 + len);
+            memcpy(out.data() + pos, &len, 4);
+            memcpy(out.data() + pos + 4, bytes.data(), len);
+        }
+        if (type == StructureType::COLUMNAR) appendColumnarState(tableName, out);
+
+        return replaceFile(tableSnapshotPath(tableName), out);
+    }
+
+    // A table whose snapshot could not be written stays dirty and is tried again
+    // at the next checkpoint
+    void StorageEngine::saveSnapshots() {
+        for (auto it = dirtySnapshots.begin(); it != dirtySnapshots.end();) {
+            if (saveSnapshot(*it)) {
+                it = dirtySnapshots.erase(it);
+            } else {
+                cerr << "Warning: could not write the snapshot of table '" << *it << "'" << endl;
+                ++it;
+            }
+        }
+    }
+
+    // Fills the (empty) structure of a table registered from its meta file
+    StorageEngine::SnapshotLoad StorageEngine::loadSnapshot(const string& tableName, StructureType type) {
+        string path = tableSnapshotPath(tableName);
+        error_code ec;
+        if (!fs::exists(path, ec)) return SnapshotLoad::MISSING;
+        ifstream f(path, ios::binary | ios::ate);
+        if (!f) return SnapshotLoad::DAMAGED;
+        vector<uint8_t> in(static_cast<size_t>(f.tellg()));
+        f.seekg(0);
+        if (in.size() < SNAPSHOT_HEADER_BYTES || !f.read(reinterpret_cast<char*>(in.data()), in.size()))
+            return SnapshotLoad::DAMAGED;
+
+        uint32_t magic = 0, count = 0;
+        memcpy(&magic, in.data(), 4);
+        memcpy(&count, in.data() + 5, 4);
+        if (magic != SNAPSHOT_MAGIC || in[4] != static_cast<uint8_t>(type)) return SnapshotLoad::DAMAGED;
+
+        vector<Record> records;
+        records.reserve(count);
+        size_t pos = SNAPSHOT_HEADER_BYTES;
+        for (uint32_t i = 0; i < count; ++i) {
+            uint32_t len = 0;
+            if (pos + 4 > in.size()) return SnapshotLoad::DAMAGED;
+            memcpy(&len, in.data() + pos, 4);
+            pos += 4;
+            Record rec;
+            if (pos + len > in.size() || !RecordCodec::decodeTagged(in.data() + pos, len, rec)) return SnapshotLoad::DAMAGED;
+            if (rec.fields.empty() || !holds_alternative<int>(rec.fields[0])) return SnapshotLoad::DAMAGED;
+            pos += len;
+            records.push_back(move(rec));
+        }
+
+        if (type == StructureType::COLUMNAR)
+            return loadColumnarState(tableName, records, in, pos) ? SnapshotLoad::LOADED : SnapshotLoad::DAMAGED;
+
+        auto idOf = [](const Record& r) { return get<int>(r.fields[0]); };
+        if (type == StructureType::AVL) {
+            bool strictlySorted = adjacent_find(records.begin(), records.end(), [&](const Record& a, const Record& b) {
+                return idOf(a) >= idOf(b);
+            }) == records.end();
+            if (strictlySorted) {
+                avlTables[tableName].bulkLoad(records);
+            } else {
+                for (const Record& rec : records) avlTables[tableName].insert(rec);
+            }
+        } else if (type == StructureType::BST) {
+            bstTables[tableName].loadPreOrder(records);
+        } else if (type == StructureType::HASH) {
+            for (const Record& rec : records) hashTables[tableName].insert(rec);
+        }
+        return SnapshotLoad::LOADED;
+    }
+
+} // namespace ChronoDB
@@ -0,0 +1,173 @@
+// table_cursor.cpp
+#include "storage.h"
+#include <climits>
+#include <algorithm>
+using namespace std;
+
+namespace ChronoDB {
+
+    // ---------- Table cursors ----------
+    // A cursor keeps only its position between batches, never a pointer into a
+    // structure, so inserts and VACUUM can run while it is open:
+    //   HEAP:  (page, slot) of the next slot; slot IDs are stable
+    //   HASH:  (bucket, entry in chain)
+    //   AVL / BST / BTREE: the next id, re-found with one O(log n) descent
+    //   COLUMNAR: the next row number
+
+    TableCursor::TableCursor(StorageEngine* engine, const string& tableName, StructureType structure,
+                             size_t batchRows, int from, int to, bool bounded)
+        : engine(engine), tableName(tableName), structure(structure), batchRows(max<size_t>(batchRows, 1)),
+          from(from), to(to), bounded(bounded), exhausted(engine == nullptr || from > to), nextId(from) {}
+
+    bool TableCursor::next(vector<Record>& batch) {
+        batch.clear();
+        // a bounded HEAP/HASH batch can filter down to nothing before the end
+        while (batch.empty() && !exhausted)
+            engine->readCursorBatch(*this, [&](const RecordView& row) { batch.push_back(row.toRecord()); });
+        return !batch.empty();
+    }
+
+    bool TableCursor::next(Record& row) {
+        if (pendingPos >= pending.size()) {
+            pendingPos = 0;
+            if (!next(pending)) return false;
+        }
+        row = move(pending[pendingPos++]);
+        return true;
+    }
+
+    void TableCursor::forEach(const RowVisitor& visit) {
+        while (!exhausted) engine->readCursorBatch(*this, visit);
+    }
+
+    void TableCursor::forEachWhere(size_t column, const RowTest& test, const RowVisitor& visit) {
+        filter = &test;
+        filterColumn = column;
+        forEach(visit);
+        filter = nullptr;
+    }
+
+    TableCursor StorageEngine::openCursor(const string& tableName, size_t batchRows) {
+        const TableInfo* table = getTableInfo(tableName);
+        if (!table) return TableCursor(nullptr, tableName, StructureType::HEAP, batchRows, INT_MIN, INT_MAX, false);
+        return TableCursor(this, tableName, table->structure, batchRows, INT_MIN, INT_MAX, false);
+    }
+
+    TableCursor StorageEngine::openRangeCursor(const string& tableName, int from, int to, size_t batchRows) {
+        const TableInfo* table = getTableInfo(tableName);
+        if (!table) return TableCursor(nullptr, tableName, StructureType::HEAP, batchRows, from, to, true);
+        return TableCursor(this, tableName, table->structure, batchRows, from, to, true);
+    }
+
+    void StorageEngine::readCursorBatch(TableCursor& cursor, const TableCursor::RowVisitor& emit) {
+        lock_guard<recursive_mutex> lock(engineMutex);
+        if (!openTable(cursor.tableName)) {
+            cursor.exhausted = true;
+            return;
+        }
+        size_t emitted = 0;
+        auto emitMatching = [&](const RecordView& row) {
+            if (!cursor.filter || (*cursor.filter)(row)) emit(row);
+        };
+        auto emitInRange = [&](const RecordView& row) {
+            if (cursor.bounded) {
+                optional<int> id = row.id();
+                if (!id.has_value() || *id < cursor.from || *id > cursor.to) return;
+            }
+            emitMatching(row);
+            emitted++;
+        };
+        RecordView view;
+        const RecordCodec& codec = codecFor(cursor.tableName);
+
+        switch (cursor.structure) {
+            case StructureType::AVL:
+            case StructureType::BST:
+            case StructureType::BTREE:
+                emitted = readOrderedBatch(cursor, emitMatching);
+                break;
+            case StructureType::COLUMNAR:
+                emitted = readColumnarBatch(cursor, emit);
+                break;
+            case StructureType::HASH: {
+                size_t added = hashTables[cursor.tableName].visitFrom(cursor.bucket, cursor.position, cursor.batchRows,
+                                                                      [&](const Record& rec) {
+                    view.reset(rec);
+                    emitInRange(view);
+                });
+                if (added < cursor.batchRows) cursor.exhausted = true;
+                break;
+            }
+            case StructureType::HEAP:
+            default: {
+                // stop after batchRows slots, matching or not, and resume at the next one
+                size_t visited = 0;
+                cursor.exhausted = true;
+                scanHeap(cursor.tableName, [&](uint32_t page, uint16_t slot, const uint8_t* raw, uint16_t len) {
+                    if (visited == cursor.batchRows) {
+                        cursor.page = page;
+                        cursor.slot = slot;
+                        cursor.exhausted = false;
+                        return false;
+                    }
+                    visited++;
+                    if (view.parse(codec, raw, len)) emitInRange(view);
+                    return true;
+                }, cursor.page, cursor.slot);
+                break;
+            }
+        }
+
+        cursor.rowsReturned += emitted;
+        // a finished full scan knows the exact row count
+        if (cursor.exhausted && !cursor.bounded && !cursor.filter) catalog.setRowCount(cursor.tableName, cursor.rowsReturned);
+    }
+
+    // Id-ordered structures: seek to nextId, skip the rows with that id this cursor
+    // already returned (a BST keeps duplicate ids), then read up to batchRows
+    size_t StorageEngine::readOrderedBatch(TableCursor& cursor, const TableCursor::RowVisitor& emit) {
+        size_t skip = cursor.skipAtNextId;
+        size_t want = cursor.batchRows + skip;
+        if (want < cursor.batchRows) want = SIZE_MAX;
+        size_t found = 0, emitted = 0;
+        bool pastEnd = false;
+        auto take = [&](const RecordView& row) {
+            if (pastEnd || found++ < skip) return;
+            optional<int> id = row.id();
+            if (!id.has_value()) return;
+            if (*id > cursor.to) {
+                pastEnd = true;
+                return;
+            }
+            if (*id == cursor.nextId) {
+                cursor.skipAtNextId++;
+            } else {
+                cursor.nextId = *id;
+                cursor.skipAtNextId = 1;
+            }
+            emit(row);
+            emitted++;
+        };
+
+        RecordView view;
+        const RecordCodec& codec = codecFor(cursor.tableName);
+        auto takeRecord = [&](const Record& rec) {
+            view.reset(rec);
+            take(view);
+        };
+        if (cursor.structure == StructureType::AVL) {
+            avlTables[cursor.tableName].visitFrom(cursor.nextId, want, takeRecord);
+        } else if (cursor.structure == StructureType::BST) {
+            bstTables[cursor.tableName].visitFrom(cursor.nextId, want, takeRecord);
+        } else if (BPlusTree* tree = btreeTable(cursor.tableName)) {
+            tree->scan(cursor.nextId, cursor.to, [&](int32_t, const uint8_t* value, uint16_t len) {
+                if (view.parse(codec, value, len)) take(view);
+                else found++;
+                return found < want && !pastEnd;
+            });
+        }
+        if (found < want || pastEnd) cursor.exhausted = true;
+        return emitted;
+    }
+
+} // namespace ChronoDB
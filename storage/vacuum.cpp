@@ -0,0 +1,216 @@
+// vacuum.cpp
+#include "storage.h"
+#include <cstring>
+using namespace std;
+
+namespace ChronoDB {
+
+    // ---------- VACUUM ----------
+    StorageEngine::HeapStats StorageEngine::heapStats(const string& tableName) {
+        lock_guard<recursive_mutex> lock(engineMutex);
+        HeapStats stats;
+        stats.pageSize = pageSizeOf(tableName);
+        stats.pages = pageCount(tableName);
+        for (uint32_t i = 0; i < stats.pages; ++i) {
+            PageHandle p(bufferPool, tableName, i);
+            if (!p.valid()) break;
+            stats.liveBytes += p->liveBytes();
+            stats.deadBytes += p->deadBytes();
+        }
+        return stats;
+    }
+
+    // Three passes, each step holding the engine lock for a single page:
+    //  1. compact every page that has dead bytes (slot IDs stay the same) and pull
+    //     relocated records back home where they fit again
+    //  2. walking back from the end, move the records of sparse pages, and of every
+    //     page while all pages after it are empty, into earlier pages with room
+    //  3. truncate the empty tail and hand the space back
+    optional<StorageEngine::VacuumResult> StorageEngine::vacuum(const string& tableName) {
+        {
+            lock_guard<recursive_mutex> lock(engineMutex);
+            const TableInfo* table = catalog.find(tableName);
+            if (!table || table->structure != StructureType::HEAP) return nullopt;
+            if (!tableFile(tableName)) return nullopt;
+        }
+
+        VacuumResult result;
+        result.before = heapStats(tableName);
+
+        for (uint32_t i = 0;; ++i) {
+            lock_guard<recursive_mutex> lock(engineMutex);
+            if (i >= pageCount(tableName)) break;
+            if (compactPage(tableName, i)) result.pagesCompacted++;
+        }
+
+        bool emptyTail = true;
+        for (uint32_t i = result.before.pages; i-- > 1;) {
+            lock_guard<recursive_mutex> lock(engineMutex);
+            if (i >= pageCount(tableName)) continue;
+            bool nowEmpty = false;
+            result.recordsMoved += emptyPage(tableName, i, !emptyTail, nowEmpty);
+            emptyTail = emptyTail && nowEmpty;
+        }
+
+        {
+            unique_lock<recursive_mutex> lock(engineMutex);
+            result.pagesTruncated = truncateEmptyTail(tableName);
+            deadBytesSinceVacuum.erase(tableName);
+            commitWrite(lock);
+        }
+
+        result.after = heapStats(tableName);
+        return result;
+    }
+
+    void StorageEngine::logPageImage(const string& tableName, uint32_t pageIndex, Page& page) {
+        vector<uint8_t> image;
+        page.serializeToBuffer(image);
+        page.setPageLSN(logHeapOp(LogType::PAGE_IMAGE, tableName, pageIndex, 0, image.data(), image.size()));
+    }
+
+    // Compacts the page and, while there is room, pulls relocated records back into
+    // their forwarding stubs so later reads need no extra hop.
+    bool StorageEngine::compactPage(const string& tableName, uint32_t pageIndex) {
+        PageHandle p(bufferPool, tableName, pageIndex);
+        if (!p.valid()) return false;
+        bool hasStubs = false;
+        for (uint16_t s = 0; s < p->slotCount(); ++s) hasStubs = hasStubs || p->slot(s).state == SLOT_FORWARD;
+        if (p->deadBytes() == 0 && !hasStubs) return false;
+        p->compact();
+
+        vector<RecordLocation> pulled;
+        for (uint16_t s = 0; hasStubs && s < p->slotCount(); ++s) {
+            if (p->slot(s).state != SLOT_FORWARD) continue;
+            optional<RecordLocation> target = p->linkedLocation(s);
+            if (!target.has_value() || target->pageIndex == pageIndex) continue;
+
+            PageHandle t(bufferPool, tableName, target->pageIndex);
+            vector<uint8_t> bytes;
+            if (!t.valid() || !t->readRawRecord(target->slotID, bytes)) continue;
+            if (!p->replaceRecord(s, bytes)) continue; // no room here (yet)
+            p->setSlotState(s, SLOT_LIVE);
+            pulled.push_back(*target);
+        }
+        if (!pulled.empty()) p->compact();
+
+        // the new home image is logged before the old copies are deleted
+        logPageImage(tableName, pageIndex, *p);
+        p.markDirty();
+        freeSpaceMap(tableName)->update(pageIndex, p->freeSpace());
+        for (const RecordLocation& loc : pulled) {
+            PageHandle t(bufferPool, tableName, loc.pageIndex);
+            if (!t.valid() || !t->deleteSlot(loc.slotID)) continue;
+            t->setPageLSN(logHeapOp(LogType::HEAP_DELETE, tableName, loc.pageIndex, loc.slotID, nullptr, 0));
+            t.markDirty();
+        }
+        return true;
+    }
+
+    // Moves the records of a page into earlier pages. Plain records get a new record
+    // ID and index entry; relocated ones keep theirs because their home stub is
+    // repointed. Pages holding forwarding stubs are left alone (the stubs are record IDs).
+    uint32_t StorageEngine::emptyPage(const string& tableName, uint32_t pageIndex, bool onlyIfSparse, bool& nowEmpty) {
+        PageHandle src(bufferPool, tableName, pageIndex);
+        nowEmpty = src.valid() && src->slotCount() == 0;
+        if (!src.valid() || src->slotCount() == 0) return 0;
+        if (onlyIfSparse && src->liveBytes() > (src->size() - PAGE_HEADER_RESERVED) * VACUUM_MERGE_FILL) return 0;
+        for (uint16_t s = 0; s < src->slotCount(); ++s)
+            if (src->slot(s).state == SLOT_FORWARD) return 0;
+        primaryIndexForWrite(tableName);
+
+        const RecordCodec& codec = codecFor(tableName);
+        uint32_t moved = 0;
+        for (uint16_t s = 0; s < src->slotCount(); ++s) {
+            SlotEntry e = src->slot(s);
+            if (!e.holdsRecord()) continue;
+
+            vector<uint8_t> raw(src->data.begin() + e.offset, src->data.begin() + e.offset + e.length);
+            optional<RecordLocation> home;
+            if (e.state == SLOT_MOVED) home = src->linkedLocation(s);
+
+            optional<RecordLocation> target = placeRecord(tableName, raw, e.state, pageIndex);
+            if (!target.has_value()) break;
+
+            src->deleteSlot(s);
+            src->setPageLSN(logHeapOp(LogType::HEAP_DELETE, tableName, pageIndex, s, nullptr, 0));
+            src.markDirty();
+
+            int id = 0;
+            if (!home.has_value() && codec.peekId(raw.data(), raw.size(), id)) indexPut(tableName, id, *target);
+
+            if (home.has_value()) {
+                PageHandle h(bufferPool, tableName, home->pageIndex);
+                if (h.valid() && h->setForward(home->slotID, *target)) {
+                    vector<uint8_t> stub(FORWARD_BYTES);
+                    memcpy(stub.data(), &target->pageIndex, 4);
+                    memcpy(stub.data() + 4, &target->slotID, 2);
+                    h->setPageLSN(logHeapOp(LogType::HEAP_FORWARD, tableName, home->pageIndex, home->slotID, stub.data(), stub.size()));
+                    h.markDirty();
+                }
+            }
+            moved++;
+        }
+
+        if (moved > 0) {
+            src->compact();
+            logPageImage(tableName, pageIndex, *src);
+            freeSpaceMap(tableName)->update(pageIndex, src->freeSpace());
+        }
+        nowEmpty = src->slotCount() == 0;
+        return moved;
+    }
+
+    uint32_t StorageEngine::truncateEmptyTail(const string& tableName) {
+        uint32_t pages = pageCount(tableName);
+        uint32_t keep = pages;
+        while (keep > 1) {
+            PageHandle p(bufferPool, tableName, keep - 1);
+            if (!p.valid() || p->slotCount() != 0) break;
+            keep--;
+        }
+        if (keep == pages) return 0;
+
+        // the truncate reaches the file right away, so its log record must be durable first
+        if (!wal.flushTo(logHeapOp(LogType::TABLE_TRUNCATE, tableName, keep, 0, nullptr, 0))) return 0;
+        bufferPool.discardPages(tableName, keep);
+        if (!tableFile(tableName)->truncate(keep)) return 0;
+        freeSpaceMap(tableName)->resize(keep);
+        return pages - keep;
+    }
+
+    // ---------- Autovacuum ----------
+    void StorageEngine::setAutoVacuum(bool enabled) {
+        if (enabled == autoVacuumThread.joinable()) return;
+        if (enabled) {
+            autoVacuumStop = false;
+            autoVacuumThread = thread(&StorageEngine::autoVacuumLoop, this);
+            return;
+        }
+        {
+            lock_guard<mutex> lk(autoVacuumMutex);
+            autoVacuumStop = true;
+        }
+        autoVacuumWake.notify_all();
+        autoVacuumThread.join();
+    }
+
+    void StorageEngine::autoVacuumLoop() {
+        unique_lock<mutex> lk(autoVacuumMutex);
+        while (!autoVacuumWake.wait_for(lk, AUTOVACUUM_INTERVAL, [this] { return autoVacuumStop; })) {
+            lk.unlock();
+            vector<string> due;
+            {
+                lock_guard<recursive_mutex> lock(engineMutex);
+                for (const auto& entry : deadBytesSinceVacuum) {
+                    uint64_t tableBytes = static_cast<uint64_t>(pageCount(entry.first)) * pageSizeOf(entry.first);
+                    if (entry.second >= AUTOVACUUM_MIN_DEAD_BYTES && entry.second >= tableBytes * AUTOVACUUM_DEAD_RATIO)
+                        due.push_back(entry.first);
+                }
+            }
+            for (const string& table : due) vacuum(table);
+            lk.lock();
+        }
+    }
+
+} // namespace ChronoDB
@@ -0,0 +1,416 @@
+// wal.cpp
+#include "wal.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace ChronoDB {
+
+    static constexpr char WAL_MAGIC[8] = {'C', 'H', 'R', 'N', 'W', 'A', 'L', '1'};
+    static constexpr size_t WAL_HEADER_SIZE = 16;    // magic + baseLSN
+    static constexpr size_t RECORD_FRAME_SIZE = 8;   // length + crc
+
+    // ---------- helpers ----------
+    static uint32_t crc32(const uint8_t* data, size_t n) {
+        static uint32_t table[256];
+        static bool ready = false;
+        if (!ready) {
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                table[i] = c;
+            }
+            ready = true;
+        }
+        uint32_t c = 0xFFFFFFFFu;
+        for (size_t i = 0; i < n; ++i) c = table[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+        return c ^ 0xFFFFFFFFu;
+    }
+
+    static bool writeFully(int fd, const uint8_t* data, size_t n) {
+        while (n > 0) {
+#ifdef _WIN32
+            int w = _write(fd, data, static_cast<unsigned>(n));
+#else
+            ssize_t w = ::write(fd, data, n);
+#endif
+            if (w <= 0) return false;
+            data += w;
+            n -= static_cast<size_t>(w);
+        }
+        return true;
+    }
+
+    static bool syncFile(int fd) {
+#ifdef _WIN32
+        return _commit(fd) == 0;
+#else
+        return fsync(fd) == 0;
+#endif
+    }
+
+    static bool truncateFile(int fd, uint64_t size) {
+#ifdef _WIN32
+        return _chsize_s(fd, static_cast<long long>(size)) == 0;
+#else
+        return ftruncate(fd, static_cast<off_t>(size)) == 0;
+#endif
+    }
+
+    template <typename T>
+    static void put(vector<uint8_t>& out, const T& v) {
+        size_t pos = out.size();
+        out.resize(pos + sizeof(T));
+        memcpy(out.data() + pos, &v, sizeof(T));
+    }
+
+    template <typename T>
+    static bool take(const uint8_t*& p, const uint8_t* end, T& v) {
+        if (static_cast<size_t>(end - p) < sizeof(T)) return false;
+        memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+
+    // ---------- WriteAheadLog ----------
+    WriteAheadLog::~WriteAheadLog() {
+        close();
+    }
+
+    bool WriteAheadLog::open(const string& logPath, DurabilityMode durability, uint64_t minLSN) {
+        close();
+        path = logPath;
+        mode = durability;
+        if (!openDescriptor()) return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0) { close(); return false; }
+
+        bool fresh = static_cast<size_t>(st.st_size) < WAL_HEADER_SIZE;
+        if (!fresh) {
+            ifstream in(path, ios::binary);
+            char magic[8];
+            in.read(magic, sizeof(magic));
+            in.read(reinterpret_cast<char*>(&baseLSN), sizeof(baseLSN));
+            if (!in || memcmp(magic, WAL_MAGIC, sizeof(magic)) != 0) { close(); return false; }
+            next = baseLSN + (static_cast<uint64_t>(st.st_size) - WAL_HEADER_SIZE);
+            // a log that ends before the last checkpoint holds nothing recovery needs
+            fresh = next < minLSN;
+        }
+        if (fresh) {
+            // pages on disk may carry LSNs up to minLSN: new records must come after
+            // them or redo would skip them. LSN 0 means "never logged" in page headers.
+            baseLSN = max<uint64_t>(minLSN, 1);
+            if (!truncateFile(fd, 0) || !writeHeader()) { close(); return false; }
+            next = baseLSN;
+        }
+        durable = next;
+        failed = false;
+        stopping = false;
+        flusher = thread(&WriteAheadLog::flusherLoop, this);
+        return true;
+    }
+
+    void WriteAheadLog::close() {
+        if (flusher.joinable()) {
+            {
+                lock_guard<mutex> lk(mtx);
+                stopping = true;
+            }
+            flushWanted.notify_all();
+            flusher.join();
+        }
+        if (fd < 0) return;
+        writeBuffered();
+#ifdef _WIN32
+        ::_close(fd);
+#else
+        ::close(fd);
+#endif
+        fd = -1;
+    }
+
+    bool WriteAheadLog::openDescriptor() {
+#ifdef _WIN32
+        fd = ::_open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+#endif
+        return fd >= 0;
+    }
+
+    bool WriteAheadLog::writeHeader() {
+        vector<uint8_t> header(WAL_MAGIC, WAL_MAGIC + sizeof(WAL_MAGIC));
+        put(header, baseLSN);
+        return writeFully(fd, header.data(), header.size()) && syncFile(fd);
+    }
+
+    void WriteAheadLog::setDurabilityMode(DurabilityMode m) {
+        {
+            lock_guard<mutex> lk(mtx);
+            mode = m;
+        }
+        flushWanted.notify_all();
+    }
+
+    uint64_t WriteAheadLog::append(LogRecord& rec) {
+        vector<uint8_t> body;
+        body.reserve(16 + rec.table.size() + rec.payload.size());
+        put(body, static_cast<uint8_t>(rec.type));
+        put(body, static_cast<uint16_t>(rec.table.size()));
+        body.insert(body.end(), rec.table.begin(), rec.table.end());
+        put(body, rec.pageIndex);
+        put(body, rec.slotID);
+        put(body, static_cast<uint32_t>(rec.payload.size()));
+        body.insert(body.end(), rec.payload.begin(), rec.payload.end());
+
+        uint32_t length = static_cast<uint32_t>(RECORD_FRAME_SIZE + body.size());
+        uint32_t crc = crc32(body.data(), body.size());
+
+        bool wakeFlusher = false;
+        {
+            lock_guard<mutex> lk(mtx);
+            rec.lsn = next;
+            put(buffer, length);
+            put(buffer, crc);
+            buffer.insert(buffer.end(), body.begin(), body.end());
+            next += length;
+            wakeFlusher = buffer.size() >= ASYNC_FLUSH_BYTES;
+        }
+        if (wakeFlusher) flushWanted.notify_one();
+        return rec.lsn;
+    }
+
+    bool WriteAheadLog::commit(uint64_t lsn) {
+        DurabilityMode m;
+        {
+            lock_guard<mutex> lk(mtx);
+            m = mode;
+        }
+        if (m == DurabilityMode::SYNC) return flushTo(lsn);
+        if (m == DurabilityMode::GROUP) {
+            unique_lock<mutex> lk(mtx);
+            if (durable > lsn) return true;
+            uint64_t failures = failedWrites;
+            waiters++;
+            flushWanted.notify_one();
+            flushed.wait(lk, [&] { return durable > lsn || stopping || failedWrites != failures; });
+            waiters--;
+            return durable > lsn;
+        }
+        // ASYNC: the flusher picks the record up within ASYNC_FLUSH_INTERVAL
+        lock_guard<mutex> lk(mtx);
+        return !failed;
+    }
+
+    bool WriteAheadLog::flushTo(uint64_t lsn) {
+        {
+            lock_guard<mutex> lk(mtx);
+            if (durable > lsn) return true;
+        }
+        return writeBuffered();
+    }
+
+    bool WriteAheadLog::flushAll() {
+        return writeBuffered();
+    }
+
+    // One write + one fsync for everything buffered so far; wakes every commit it covers.
+    // The buffer always starts at durable, so a failed write is cut off the file and
+    // its bytes go back in front of the buffer: LSNs stay file positions. A failed
+    // fsync fails the log for good, since the kernel may have dropped the pages.
+    bool WriteAheadLog::writeBuffered() {
+        lock_guard<mutex> io(ioMutex);
+        vector<uint8_t> out;
+        uint64_t from, target;
+        {
+            lock_guard<mutex> lk(mtx);
+            if (failed) return false;
+            if (durable >= next) return true;
+            out.swap(buffer);
+            from = durable;
+            target = next;
+            lastGroupSize = waiters;
+        }
+        bool written = fd >= 0 && writeFully(fd, out.data(), out.size());
+        bool synced = written && syncFile(fd);
+        {
+            lock_guard<mutex> lk(mtx);
+            if (synced) {
+                fsyncs++;
+                durable = target;
+            } else {
+                // records appended meanwhile stay behind the unwritten ones
+                buffer.insert(buffer.begin(), out.begin(), out.end());
+                failedWrites++;
+                if (written || fd < 0 || !truncateFile(fd, WAL_HEADER_SIZE + (from - baseLSN))) failed = true;
+            }
+        }
+        flushed.notify_all();
+        return synced;
+    }
+
+    void WriteAheadLog::flusherLoop() {
+        unique_lock<mutex> lk(mtx);
+        while (!stopping) {
+            if (failed) {
+                flushWanted.wait(lk, [&] { return stopping; });
+                break;
+            }
+            if (mode == DurabilityMode::ASYNC) {
+                flushWanted.wait_for(lk, ASYNC_FLUSH_INTERVAL, [&] {
+                    return stopping || mode != DurabilityMode::ASYNC || buffer.size() >= ASYNC_FLUSH_BYTES;
+                });
+            } else {
+                flushWanted.wait(lk, [&] {
+                    return stopping || mode == DurabilityMode::ASYNC ||
+                           (durable < next && (waiters > 0 || buffer.size() >= ASYNC_FLUSH_BYTES));
+                });
+                // Concurrent committers were seen last time: give them a moment to join this group
+                if (!stopping && mode == DurabilityMode::GROUP && lastGroupSize > 1)
+                    flushWanted.wait_for(lk, GROUP_COMMIT_WINDOW);
+            }
+            if (stopping) break;
+            if (durable >= next) continue;
+            lk.unlock();
+            bool ok = writeBuffered();
+            lk.lock();
+            // a failed write is retried after a pause, not in a tight loop
+            if (!ok && !stopping) flushWanted.wait_for(lk, ASYNC_FLUSH_INTERVAL);
+        }
+    }
+
+    uint64_t WriteAheadLog::scan(uint64_t fromLSN, const function<void(const LogRecord&)>& visit) {
+        writeBuffered();
+        ifstream in(path, ios::binary);
+        if (!in) return 0;
+
+        uint64_t start = max(fromLSN, baseLSN);
+        uint64_t offset = WAL_HEADER_SIZE + (start - baseLSN);
+        in.seekg(static_cast<streamoff>(offset));
+
+        uint64_t bytesRead = 0;
+        vector<uint8_t> body;
+        while (true) {
+            uint32_t length = 0, crc = 0;
+            if (!in.read(reinterpret_cast<char*>(&length), sizeof(length))) break;
+            if (!in.read(reinterpret_cast<char*>(&crc), sizeof(crc))) break;
+            if (length < RECORD_FRAME_SIZE + 13) break;
+            body.resize(length - RECORD_FRAME_SIZE);
+            if (!in.read(reinterpret_cast<char*>(body.data()), body.size())) break;
+            if (crc32(body.data(), body.size()) != crc) break;
+
+            LogRecord rec;
+            rec.lsn = baseLSN + (offset - WAL_HEADER_SIZE);
+            const uint8_t* p = body.data();
+            const uint8_t* end = p + body.size();
+            uint8_t type = 0; uint16_t tableLen = 0; uint32_t payloadLen = 0;
+            take(p, end, type);
+            take(p, end, tableLen);
+            if (static_cast<size_t>(end - p) < tableLen) break;
+            rec.type = static_cast<LogType>(type);
+            rec.table.assign(reinterpret_cast<const char*>(p), tableLen);
+            p += tableLen;
+            if (!take(p, end, rec.pageIndex) || !take(p, end, rec.slotID) || !take(p, end, payloadLen)) break;
+            if (static_cast<size_t>(end - p) < payloadLen) break;
+            rec.payload.assign(p, p + payloadLen);
+
+            visit(rec);
+            offset += length;
+            bytesRead += length;
+        }
+
+        // Anything after the last good record is a torn write from a crash: cut it off
+        lock_guard<mutex> lk(mtx);
+        uint64_t validEnd = baseLSN + (offset - WAL_HEADER_SIZE);
+        if (validEnd < next && buffer.empty()) {
+            truncateFile(fd, offset);
+            next = durable = validEnd;
+        }
+        return bytesRead;
+    }
+
+    // Swapped in like truncateBefore does, so a crash leaves either the old log or
+    // an empty one that still starts at the current LSN
+    bool WriteAheadLog::reset() {
+        if (!writeBuffered()) return false;
+        return truncateBefore(nextLSN());
+    }
+
+    // Rewrites the log as [header(baseLSN = lsn)][records >= lsn] and swaps it in
+    // with a rename, so a crash leaves either the old or the new file.
+    bool WriteAheadLog::truncateBefore(uint64_t lsn) {
+        writeBuffered();
+        lock_guard<mutex> io(ioMutex);
+        lock_guard<mutex> lk(mtx);
+        if (fd < 0 || lsn <= baseLSN) return true;
+        if (lsn > durable) lsn = durable;
+
+        string tmpPath = path + ".tmp";
+        {
+            ifstream in(path, ios::binary);
+            if (!in) return false;
+            in.seekg(static_cast<streamoff>(WAL_HEADER_SIZE + (lsn - baseLSN)));
+
+#ifdef _WIN32
+            int out = ::_open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+            int out = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+            if (out < 0) return false;
+            vector<uint8_t> chunk(WAL_MAGIC, WAL_MAGIC + sizeof(WAL_MAGIC));
+            put(chunk, lsn);
+            bool ok = writeFully(out, chunk.data(), chunk.size());
+            chunk.resize(1u << 16);
+            while (ok && in.read(reinterpret_cast<char*>(chunk.data()), chunk.size()).gcount() > 0)
+                ok = writeFully(out, chunk.data(), static_cast<size_t>(in.gcount()));
+            ok = ok && syncFile(out);
+#ifdef _WIN32
+            ::_close(out);
+#else
+            ::close(out);
+#endif
+            if (!ok) return false;
+        }
+
+#ifdef _WIN32
+        ::_close(fd);
+#else
+        ::close(fd);
+#endif
+        fd = -1;
+        error_code ec;
+        fs::rename(tmpPath, path, ec);
+        if (!openDescriptor()) return false;
+        if (ec) return false;
+        syncFile(fd);
+        baseLSN = lsn;
+        return true;
+    }
+
+    uint64_t WriteAheadLog::nextLSN() const {
+        lock_guard<mutex> lk(mtx);
+        return next;
+    }
+
+    uint64_t WriteAheadLog::durableLSN() const {
+        lock_guard<mutex> lk(mtx);
+        return durable;
+    }
+
+    uint64_t WriteAheadLog::sizeBytes() const {
+        lock_guard<mutex> lk(mtx);
+        return WAL_HEADER_SIZE + (next - baseLSN);
+    }
+
+} // namespace ChronoDB
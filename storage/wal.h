@@ -0,0 +1,124 @@
+#ifndef CHRONODB_WAL_H
+#define CHRONODB_WAL_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <condition_variable>
+using namespace std;
+
+namespace ChronoDB {
+
+    // -------- Log Records --------
+    enum class LogType : uint8_t {
+        HEAP_INSERT = 1,    // slot bytes inserted into a page (redo: insertRawRecord)
+        HEAP_DELETE = 2,    // slot tombstoned (redo: deleteSlot)
+        PAGE_IMAGE = 3,     // full after-image of a page
+        TABLE_TRUNCATE = 4, // table file cut to pageIndex pages
+        CHECKPOINT = 5,     // fuzzy checkpoint: payload is the dirty page table
+        HEAP_UPDATE = 6,    // slot bytes replaced (redo: replaceRecord)
+        HEAP_MOVE_IN = 7,   // relocated record inserted (redo: insertRawRecord as SLOT_MOVED)
+        HEAP_FORWARD = 8,   // slot turned into a forwarding stub (redo: setForward)
+        BTREE_PUT = 9,      // B+Tree leaf entry added or replaced (redo: BPlusTree::leafPut)
+        BTREE_REMOVE = 10,  // B+Tree leaf entry removed (redo: BPlusTree::leafRemove)
+        BTREE_IMAGES = 11   // after-images of every page of one B+Tree split, applied together
+    };
+
+    struct LogRecord {
+        LogType type = LogType::HEAP_INSERT;
+        uint64_t lsn = 0;          // assigned by append()
+        string table;
+        uint32_t pageIndex = 0;
+        uint16_t slotID = 0;
+        vector<uint8_t> payload;
+    };
+
+    // How long a statement waits for its log records to reach disk
+    enum class DurabilityMode {
+        SYNC,   // every commit writes and fsyncs the log itself
+        GROUP,  // commits queue up and share one fsync done by the flusher thread
+        ASYNC   // commits return at once; the flusher writes the log every few ms
+    };
+
+    // Append-only redo log in front of the .tbl files. Records are buffered in
+    // memory, LSNs are byte positions in the log stream, and the flusher thread
+    // turns many pending commits into a single write + fsync.
+    class WriteAheadLog {
+    public:
+        WriteAheadLog() = default;
+        ~WriteAheadLog();
+        WriteAheadLog(const WriteAheadLog&) = delete;
+        WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+        // A new log (or one older than minLSN) starts at minLSN
+        bool open(const string& path, DurabilityMode mode = DurabilityMode::GROUP, uint64_t minLSN = 1);
+        void close();
+        bool isOpen() const { return fd >= 0; }
+
+        void setDurabilityMode(DurabilityMode mode);
+        DurabilityMode durabilityMode() const { return mode; }
+
+        // Buffers the record and returns its LSN
+        uint64_t append(LogRecord& rec);
+        // Waits (according to the durability mode) until the record at lsn is durable;
+        // false when the log could not write it
+        bool commit(uint64_t lsn);
+        // Synchronously makes every record up to and including lsn durable (WAL rule)
+        bool flushTo(uint64_t lsn);
+        bool flushAll();
+
+        // Reads every valid record starting at fromLSN, in order. A torn or corrupt
+        // tail is cut off so new records are appended after the last good one.
+        // Returns the number of log bytes read.
+        uint64_t scan(uint64_t fromLSN, const function<void(const LogRecord&)>& visit);
+
+        // Drops every record (all pages are on disk); LSNs keep increasing
+        bool reset();
+        // Drops the records below lsn (no longer needed for recovery)
+        bool truncateBefore(uint64_t lsn);
+
+        uint64_t nextLSN() const;
+        uint64_t durableLSN() const;
+        uint64_t fsyncCount() const { return fsyncs; }
+        uint64_t sizeBytes() const;
+
+    private:
+        string path;
+        int fd = -1;
+        DurabilityMode mode = DurabilityMode::GROUP;
+
+        uint64_t baseLSN = 0;   // LSN of the first record byte in the file
+        uint64_t next = 0;      // LSN the next record will get
+        uint64_t durable = 0;   // every record below this LSN is on disk
+        uint64_t fsyncs = 0;
+        uint64_t failedWrites = 0;
+        bool failed = false;     // the file may hold unsynced or stray bytes: nothing more becomes durable
+
+        vector<uint8_t> buffer;  // records not yet written to the file
+        size_t waiters = 0;      // GROUP commits waiting for the flusher
+        size_t lastGroupSize = 0;
+        bool stopping = false;
+
+        mutable mutex mtx;       // guards the fields above
+        mutex ioMutex;           // serialises write + fsync so batches land in order
+        condition_variable flushWanted;
+        condition_variable flushed;
+        thread flusher;
+
+        static constexpr chrono::microseconds GROUP_COMMIT_WINDOW{200};
+        static constexpr chrono::milliseconds ASYNC_FLUSH_INTERVAL{10};
+        static constexpr size_t ASYNC_FLUSH_BYTES = 1u << 20;
+
+        void flusherLoop();
+        bool writeBuffered();
+        bool writeHeader();
+        bool openDescriptor();
+    };
+
+} // namespace ChronoDB
+
+#endif // CHRONODB_WAL_H